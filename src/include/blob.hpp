@@ -0,0 +1,30 @@
+#ifndef __BLOB_H_
+#define __BLOB_H_
+
+#include<string>
+#include<pqxx/pqxx>
+
+/* Content addressed storage of the encoded data_int and data_img payloads.
+ * A payload is kept once in smiblob under its hash and smidata refers to it
+ * by data_int_hash and data_img_hash, see script/smiblob.sql. Imports of
+ * overlapping selections then upload and store each track only once.
+ */
+
+/* SHA-256 of s as 64 lower case hex digits, the same as
+ * encode(sha256(convert_to(s, 'UTF8')), 'hex') in the database.
+ */
+std::string contentHash(const std::string& s);
+
+class BlobStore {
+  pqxx::work& work_;
+
+public:
+  BlobStore(pqxx::work& work);
+
+  /* Uploads the payload unless smiblob already holds it and returns its
+   * hash. Concurrent imports may store the same payload.
+   */
+  std::string store(const std::string& payload);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __BULK_H_
+#define __BULK_H_
+
+#include<string>
+#include<pqxx/pqxx>
+
+/* Bulk loading of an import into its own partition of smidata. The
+ * partition is a plain table without indexes while it is loaded. It
+ * becomes part of smidata only when it is attached, so readers never see a
+ * partly loaded import. smidata must be partitioned by list of dataset_id,
+ * see script/partition-smidata.sql.
+ */
+
+/* Name of the table holding the rows of one import */
+std::string smidataPartition(long int dataset_id);
+
+/* Creates the table of the import if it does not exist yet. Several shards
+ * of an import may call it.
+ */
+void createSmidataPartition(pqxx::work& w, long int dataset_id);
+
+/* Builds the indexes of the loaded table, attaches it to smidata and
+ * updates the planner statistics, all in the transaction w.
+ */
+void attachSmidataPartition(pqxx::work& w, long int dataset_id);
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef __ENGINE_H_
+#define __ENGINE_H_
+
+#include<string>
+#include<vector>
+#include<map>
+#include<set>
+#include<memory>
+#include<exception>
+#include<ostream>
+
+#include <datamodel.hpp>
+#include <msmm_project.hpp>
+
+#include "filters.hpp"
+#include "status.hpp"
+#include "options.hpp"
+
+/* The importers load each project once and hand every track to one or more
+ * sinks, which write it in their own format. The expensive work that all
+ * formats share, extrapolating the track and cutting its frame data, is done
+ * at most once per track whatever the number of sinks.
+ */
+
+/* A loaded project and what the reference file says about it */
+struct DatasetContext {
+  const std::string& source_data_set;
+  const MSMMProject::Project& project;
+  const MSMMDataModel::ImFrameStack& frames;
+  const MSMMDataModel::ChannelConfig& cc;
+  MSMMDataModel::ChId channel_id;
+  unsigned int first_frameid;
+  unsigned int last_frameid;
+  const std::vector<unsigned int>& positive_tids;
+  const std::set<std::pair<int,int>>& gdrs;
+};
+
+/* One track of a loaded project. The extrapolated track and its frame data
+ * are computed when a sink first asks for them and shared by all sinks. A
+ * failed extrapolation is rethrown to every sink asking for it.
+ */
+class TrackData {
+  const DatasetContext& dataset_;
+  MSMMDataModel::TrackId tid_;
+  const MSMMDataModel::Track& track_;
+
+  bool extracted_;
+  std::exception_ptr error_;
+  MSMMDataModel::Track extrapolated_;
+  std::vector<float> data_int_;
+  std::vector<float> data_img_;
+
+  void extract();
+
+public:
+  /* Values per frame in dataInt() and dataImg() */
+  static const unsigned int IntDim = 7;
+  static const unsigned int ImageCutSize = 5;
+  static const unsigned int ImgDim = (2*ImageCutSize + 1) * (2*ImageCutSize + 1);
+
+  TrackData(const DatasetContext& dataset,
+	    MSMMDataModel::TrackId tid,
+	    const MSMMDataModel::Track& track);
+
+  const DatasetContext& dataset() const;
+  MSMMDataModel::TrackId tid() const;
+
+  /* The track as stored in the project */
+  const MSMMDataModel::Track& track() const;
+
+  /* 1 for the tracks in the reference file, 0 for all others */
+  unsigned int category() const;
+
+  /* What the filters see of the given track, the stored one or a copy */
+  TrackContext context(const MSMMDataModel::Track& track,
+		       std::string* track_case = NULL) const;
+
+  /* Number of frames of the project, the length of a complete track */
+  unsigned int trackSize() const;
+
+  const MSMMDataModel::Track& extrapolated();
+
+  /* Frame id, counts, sigcounts, x, y, background and interpolated for
+   * each frame of the extrapolated track.
+   */
+  const std::vector<float>& dataInt();
+
+  /* The image around the track in each frame, row by row */
+  const std::vector<float>& dataImg();
+
+  /* Number of frames in dataInt() and dataImg() */
+  unsigned int frames();
+
+  /* True if the extrapolated track covers every frame of the project */
+  bool complete();
+};
+
+
+/* Writes the tracks of one data set. It is used only by the thread
+ * importing the data set.
+ */
+class DatasetWriter {
+public:
+  virtual ~DatasetWriter();
+
+  /* Returns TrackImported or why the track was not written. Errors of a
+   * single track are reported as TrackFailed; an exception aborts the
+   * import.
+   */
+  virtual TrackStatus write(TrackData& t) = 0;
+
+  /* Called after the last track of the data set */
+  virtual void close();
+};
+
+/* An output of the importer. The sink opens a writer for each data set and
+ * counts what became of the tracks. The tracks its filters reject before
+ * the levels are calculated never reach the writer.
+ */
+class TrackSink {
+  FilterChain filters_;
+  TrackStatistics stats_;
+
+public:
+  TrackSink(const std::string& filters);
+  virtual ~TrackSink();
+
+  virtual std::string name() const = 0;
+  virtual std::unique_ptr<DatasetWriter> open(const DatasetContext& d) = 0;
+
+  /* Called once all data sets are imported */
+  virtual void finish();
+
+  FilterChain& filters();
+  TrackStatistics& statistics();
+  void report(std::ostream& out) const;
+};
+
+
+class ImportEngine {
+  std::map<std::string, std::vector<unsigned int>> datasets_tracks_;
+  std::map<std::string, std::set<std::pair<int,int>>> datasets_gdrs_;
+  std::vector<TrackSink*> sinks_;
+
+  void import(const std::string& source_data_set, const Options& opts);
+
+public:
+  /* Adds the data sets and tracks of a reference file. The format is
+   * <data set>,<track id>,<gdr start>,<gdr end>. A GDR of -1,-1 is the
+   * whole data set.
+   */
+  void addReference(const std::string& reference_file);
+
+  /* Adds a data set without positive tracks or GDRs */
+  void addDataset(const std::string& source_data_set);
+
+  void addSink(TrackSink& sink);
+
+  /* Imports the data sets into every sink and finishes the sinks. Reads
+   * --shard, --shard-cost, --jobs, --memory-budget and --stats from opts.
+   */
+  void run(const Options& opts);
+};
+
+#endif
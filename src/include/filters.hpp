@@ -0,0 +1,112 @@
+#ifndef __FILTERS_H_
+#define __FILTERS_H_
+
+#include<string>
+#include<vector>
+#include<set>
+#include<memory>
+#include<atomic>
+#include<ostream>
+
+#include <datamodel.hpp>
+#include <msmm_project.hpp>
+#include "status.hpp"
+
+/* What a filter knows about the track it decides on. The track is the one
+ * stored in the project before the levels are calculated and the importer's
+ * copy of it afterwards. If track_case is set, the filter calculating the
+ * track case stores it there so the importer does not calculate it again.
+ */
+struct TrackContext {
+  MSMMDataModel::TrackId tid;
+  const MSMMDataModel::Track& track;
+  const std::vector<unsigned int>& positive_tids;
+  const std::set<std::pair<int,int>>& gdrs;
+  const MSMMProject::Project& project;
+  std::string* track_case;
+};
+
+class TrackFilter {
+public:
+  /* Filters run cheapest first. Filters cheaper than Levels run on the
+   * project's track before it is copied. The others need the levels of the
+   * track and run after the importer calculated them.
+   */
+  enum Cost { Length = 0, Label = 1, Levels = 2, TrackCase = 3 };
+
+  virtual ~TrackFilter();
+  virtual std::string name() const = 0;
+  virtual Cost cost() const = 0;
+
+  /* Returns TrackImported if the track passes, otherwise the reason */
+  virtual TrackStatus check(const TrackContext& t) const = 0;
+};
+
+/* Tracks shorter than the given number of frames */
+class MinLengthFilter : public TrackFilter {
+  unsigned int length_;
+public:
+  MinLengthFilter(unsigned int length);
+  std::string name() const;
+  Cost cost() const;
+  TrackStatus check(const TrackContext& t) const;
+};
+
+/* Tracks of a category other than the given one. Tracks in the reference
+ * file have category 1, all others 0.
+ */
+class CategoryFilter : public TrackFilter {
+  unsigned int category_;
+public:
+  CategoryFilter(unsigned int category);
+  std::string name() const;
+  Cost cost() const;
+  TrackStatus check(const TrackContext& t) const;
+};
+
+/* Tracks with fewer levels than the given number */
+class LevelCountFilter : public TrackFilter {
+  unsigned int levels_;
+public:
+  LevelCountFilter(unsigned int levels);
+  std::string name() const;
+  Cost cost() const;
+  TrackStatus check(const TrackContext& t) const;
+};
+
+/* Tracks without a track case, either because the levels do not have the
+ * expected structure or because the step is not in a global drift range.
+ */
+class GDRFilter : public TrackFilter {
+public:
+  std::string name() const;
+  Cost cost() const;
+  TrackStatus check(const TrackContext& t) const;
+};
+
+
+/* Filters given on the command line as a comma separated list, for example
+ * "min-length:20,levels:2,gdr". Known filters are min-length:<frames>,
+ * category:<category>, levels:<count> and gdr. The chain counts the tracks
+ * rejected by each filter and is safe to use from several threads.
+ */
+class FilterChain {
+public:
+  enum Stage { BeforeLevels, AfterLevels };
+
+private:
+  std::vector<std::unique_ptr<TrackFilter>> filters_;
+  std::unique_ptr<std::atomic<unsigned long>[]> rejected_;
+
+public:
+  FilterChain(const std::string& spec);
+
+  /* Runs the filters of the stage. Returns the reason of the first filter
+   * rejecting the track or TrackImported if the track passes all of them.
+   */
+  TrackStatus check(const TrackContext& t, Stage stage);
+
+  void report(std::ostream& out) const;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include<string>
 #include<set>
 #include <datamodel.hpp>
+#include "status.hpp"
 
 unsigned int trackLabel(const std::vector<unsigned int>& labels, unsigned int l);
 bool trackInGDR(const std::set<std::pair<int, int>>& gdrs, int low, int high);
@@ -22,58 +23,16 @@ std::string getScores(MSMMDataModel::Track track,
 		      MSMMDataModel::LevelOptions::LevelDetectionVersion version,
 		      const MSMMProject::Project& project);
 
-std::string getTrackCase( const MSMMDataModel::Track& track,
+/* Finds whether the first or the last level of the track is the one with
+ * one fluorophore and stores "L1First" or "L1Last" in track_case. Returns
+ * TrackImported if the track has a case. Only a project with more than one
+ * channel is an error.
+ */
+TrackStatus getTrackCase( const MSMMDataModel::Track& track,
 			  const MSMMProject::Project& project,
-			  const std::set<std::pair<int,int>> gdrs);
+			  const std::set<std::pair<int,int>>& gdrs,
+			  std::string& track_case);
 
 
-std::vector<std::string> exported_scores =  {
-  "change_probability",
-  "duration",
-  "first_frame",
-  "fragmentation",
-  "level1duration",
-  "level1points",
-  "level2duration",
-  "level2points",
-  "leveliness",
-  "longest_range",
-  "nlevels",
-  "nsteps",
-  "ratio_real_points",
-  "sec_longest",
-  "sec_most_pts",
-  "shortest_range",
-  "stepness",
-  "count_sigma_mls_12",
-  "cts_loc_sn_l1",
-  "cts_loc_sn_l2",
-  "cts_slm_l1",
-  "cts_slm_l2",
-  "cts_stdev_lvl_1",
-  "cts_stdev_lvl_2",
-  "distinctiveness",
-  "levelrchisq",
-  "maxovermlsig",
-  "maxstepfrac",
-  "maxstepprob",
-  "meanlocalsigmacounts_1",
-  "meanovermlsig",
-  "sigmacounts_1",
-  "significance",
-  "sigovermlsig",
-  "stepratio_lvl12",
-  "displacement",
-  "dr12",
-  "pos_density_12",
-  "pos_error_1",
-  "pos_error_2",
-  "pos_sigma_mls_12",
-  "pos_sigma_locmean_12",
-  "semdr12",
-  "sigdr12",
-  "total_pos_density",
-  "cts_mean_lvl_1",
-  "cts_mean_lvl_2"
-};
+extern std::vector<std::string> exported_scores;
 #endif
@@ -116,4 +116,10 @@ static const char reverse_table[128] = {
 std::string base64_encode(const std::string &bindata);
 std::string base64_decode(const ::std::string &ascdata);
 
+/* Decodes straight into out, which has room for capacity bytes. Returns the
+ * number of bytes written.
+ */
+std::size_t base64_decode(const char* ascdata, std::size_t len,
+			  unsigned char* out, std::size_t capacity);
+
 #endif
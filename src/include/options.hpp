@@ -0,0 +1,27 @@
+#ifndef __OPTIONS_H_
+#define __OPTIONS_H_
+
+#include<string>
+#include<vector>
+#include<map>
+
+/* Command line of the importers. Positional arguments keep their old meaning
+ * and order. Optional settings are given as --name value pairs and may appear
+ * anywhere on the line.
+ */
+class Options {
+  std::vector<std::string> args_;
+  std::map<std::string, std::string> flags_;
+
+public:
+  Options(int argc, char** argv);
+
+  /* Positional arguments, without the program name */
+  const std::vector<std::string>& args() const;
+
+  bool has(const std::string& name) const;
+  std::string get(const std::string& name) const;
+  std::string get(const std::string& name, const std::string& def) const;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __SCHEDULER_H_
+#define __SCHEDULER_H_
+
+#include<string>
+#include<vector>
+#include<functional>
+#include<mutex>
+#include<condition_variable>
+
+/* Bytes of memory shared by the projects loaded at the same time. A project
+ * is admitted when its estimated footprint fits into what is left of the
+ * budget. Otherwise the loader waits until other projects are released. A
+ * project larger than the whole budget is admitted only when nothing else is
+ * loaded.
+ */
+class MemoryBudget {
+  unsigned long long budget_;
+  unsigned long long in_flight_;
+  std::mutex lock_;
+  std::condition_variable released_;
+
+public:
+  /* A budget of 0 admits everything */
+  explicit MemoryBudget(unsigned long long budget);
+
+  /* False for a budget of 0, nothing needs to be estimated then */
+  bool enabled() const { return budget_ != 0; }
+
+  void acquire(unsigned long long bytes);
+  void release(unsigned long long bytes);
+};
+
+/* HDF5 is not thread safe in its default build. Everything that opens the
+ * files of a project, including the constructor of MSMMProject::Project,
+ * must hold this lock.
+ */
+std::mutex& projectLoadLock();
+
+/* Estimates the memory taken by a loaded project from the headers of its
+ * HDF5 files, without reading the frames. The estimate is the number of
+ * elements of every data set times the element size, taking at least a float
+ * per element. If the path contains no HDF5 file its size on disk is used.
+ */
+unsigned long long estimateProjectFootprint(const std::string& path);
+
+/* Calls process for each data set on the given number of threads. Before a
+ * data set is handed out its footprint is admitted to the budget and it is
+ * released after process returns. Without a budget no footprint is
+ * estimated. The first exception thrown by process stops the remaining data
+ * sets and is rethrown once all threads finished.
+ */
+void scheduleDatasets(const std::vector<std::string>& datasets,
+		      unsigned int jobs,
+		      MemoryBudget& budget,
+		      std::function<void(const std::string&)> process);
+
+#endif
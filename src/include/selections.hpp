@@ -0,0 +1,38 @@
+#ifndef __SELECTIONS_H_
+#define __SELECTIONS_H_
+
+#include<string>
+#include<vector>
+#include<tuple>
+
+#include "thread_pool.hpp"
+
+/* The manual track selections saved by the nano browser, turned into the
+ * reference file of the importers. A selection file is a CSV file whose
+ * track lines start with the data set path, followed by the track id, the
+ * x mark with the frame range of the selection and optionally the GDR.
+ */
+
+typedef std::tuple<std::string, unsigned int, int, int> ReferenceRecord;
+
+/* Finds the files named <prefix>*.csv below root. The directories are read
+ * on the pool. The files are returned sorted.
+ */
+std::vector<std::string> findSelections(const std::string& root,
+					const std::string& prefix,
+					ThreadPool& pool);
+
+/* Turns a line of a selection file into a reference record. The x mark and
+ * its frame range are dropped and a missing GDR becomes -1,-1. Returns false
+ * for lines which are not a track, throws for a track line it cannot read.
+ */
+bool parseSelection(const std::string& line, ReferenceRecord& record);
+
+/* Reads the selection files on the pool. The records keep the order of the
+ * files and of the lines in them. Lines which cannot be read are reported
+ * on stderr and skipped.
+ */
+std::vector<ReferenceRecord> readSelections(const std::vector<std::string>& files,
+					    ThreadPool& pool);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef __SHARD_H_
+#define __SHARD_H_
+
+#include<string>
+#include<vector>
+#include<map>
+#include<set>
+
+/* Partitioning of a reference file between importer processes. A shard is
+ * given on the command line as i/N with 1 <= i <= N. Every process computes
+ * the same partition, so N processes started with 1/N ... N/N import every
+ * data set exactly once.
+ */
+struct Shard {
+  unsigned int index;
+  unsigned int count;
+};
+
+Shard parseShard(const std::string& spec);
+
+/* FNV-1a hash of a data set path. Unlike std::hash it is the same on every
+ * node and every build.
+ */
+unsigned long long stableHash(const std::string& s);
+
+/* Reads the stats written by a previous run with --stats. Each line is
+ * <data set>,<frames>,<tracks> and the cost of the data set is frames * tracks.
+ */
+std::map<std::string, double> readShardCosts(const std::string& fname);
+
+/* Appends the stats of one loaded project to a file readable by
+ * readShardCosts.
+ */
+void writeShardStats(const std::string& fname,
+		     const std::string& dataset,
+		     unsigned int frames,
+		     unsigned int tracks);
+
+/* Returns the data sets belonging to the shard. Without costs the data sets
+ * are assigned by hash. With costs they are assigned greedily, the most
+ * expensive first, to the shard with the least total cost. Data sets missing
+ * from costs are assumed to have the mean cost.
+ */
+std::set<std::string> shardDatasets(const std::vector<std::string>& datasets,
+				    const Shard& shard,
+				    const std::map<std::string, double>& costs);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef __SINKS_H_
+#define __SINKS_H_
+
+#include<string>
+#include<vector>
+#include<memory>
+
+#include <datamodel/combi_score.hpp>
+#include <hdf5.h>
+
+#include "engine.hpp"
+#include "options.hpp"
+#include "blob.hpp"
+
+/* The smidata_desc entry and the table a database sink writes to. The
+ * constructor creates the entry, or uses --dataset-id, and prepares the
+ * table as asked by --bulk and --payload.
+ */
+class SmidataTarget {
+  long int dataid_;
+  std::string bulk_;
+  std::string table_;
+  bool blobs_;
+
+public:
+  SmidataTarget(const Options& opts, const std::string& info);
+
+  long int id() const;
+  const std::string& table() const;
+
+  /* The columns taking the encoded data_int and data_img */
+  std::string payloadColumns() const;
+
+  /* The encoded frame data or, with --payload blob, its hash in smiblob */
+  std::string encodePayload(BlobStore& blobs, const std::vector<float>& data) const;
+
+  /* Attaches the table with --bulk attach */
+  void finish();
+};
+
+/* smidata records with the scores and levels of the three level detection
+ * versions and the track case, as smi-db-import-classification stores them.
+ */
+class ClassificationSink : public TrackSink {
+  SmidataTarget target_;
+  MSMMDataModel::CombiScore plane_;
+
+public:
+  ClassificationSink(const Options& opts, const std::string& info,
+		     const std::string& filters);
+
+  std::string name() const;
+  std::unique_ptr<DatasetWriter> open(const DatasetContext& d);
+  void finish();
+
+  const SmidataTarget& target() const;
+  const MSMMDataModel::CombiScore& plane() const;
+};
+
+/* smidata records with the levels of the three level detection versions
+ * calculated on the extrapolated track, as smi-db-import-level-detection
+ * stores them.
+ */
+class LevelDetectionSink : public TrackSink {
+  SmidataTarget target_;
+
+public:
+  LevelDetectionSink(const Options& opts, const std::string& info,
+		     const std::string& filters);
+
+  std::string name() const;
+  std::unique_ptr<DatasetWriter> open(const DatasetContext& d);
+  void finish();
+
+  const SmidataTarget& target() const;
+};
+
+/* The files track_<tid>-intensity.csv and track_<tid>-image.csv of every
+ * track. With per_dataset the files of each data set go into a directory of
+ * their own below the given one, at the path of the data set.
+ */
+class CsvSink : public TrackSink {
+  std::string directory_;
+  bool per_dataset_;
+
+public:
+  CsvSink(const std::string& directory, bool per_dataset,
+	  const std::string& filters);
+
+  std::string name() const;
+  std::unique_ptr<DatasetWriter> open(const DatasetContext& d);
+};
+
+/* One HDF5 file with a group per track holding its data_int and data_img
+ * as frames x values arrays. The group carries the source data set, track
+ * id and category as attributes. Writing holds projectLoadLock().
+ */
+class Hdf5Sink : public TrackSink {
+  hid_t file_;
+  unsigned long groups_;
+
+public:
+  Hdf5Sink(const std::string& path, const std::string& filters);
+  ~Hdf5Sink();
+
+  std::string name() const;
+  std::unique_ptr<DatasetWriter> open(const DatasetContext& d);
+  void finish();
+
+  /* Writes the track into a new group, called with projectLoadLock() held */
+  void write(TrackData& t);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __SMIDATA_READER_H_
+#define __SMIDATA_READER_H_
+
+#include<string>
+#include<vector>
+#include<map>
+#include<pqxx/pqxx>
+
+#include "thread_pool.hpp"
+
+/* Frame ranges of every level, as written by serializeLevels */
+typedef std::vector<std::vector<std::pair<int, int>>> Levels;
+
+/* Scores by name, as written by getScores */
+typedef std::map<std::string, float> Scores;
+
+Levels parseLevels(const std::string& levels);
+Scores parseScores(const std::string& scores);
+
+/* The columns of a smidata row other than the frame data. Columns which are
+ * null in the database are left empty.
+ */
+struct SmiRecord {
+  std::string source_data_set;
+  unsigned int source_track_id;
+  int track_start;
+  int track_end;
+  unsigned int category;
+  std::string levels_order;
+
+  /* Number of frames in data_int and data_img. The rest of the track_size
+   * frames reserved for the record are NaN.
+   */
+  unsigned int length;
+
+  Levels levels;
+  Levels levels_old;
+  Levels levels_new;
+
+  Scores scores;
+  Scores scores_old;
+  Scores scores_new;
+};
+
+/* Reads all smidata rows of an import into contiguous arrays. The rows are
+ * fetched in batches through a cursor and their frame data is decoded on a
+ * thread pool while the next batch is fetched.
+ *
+ * Rows are ordered by source data set and track id. Row n occupies
+ *   data_int[n * trackSize() * intDim() ... (n+1) * trackSize() * intDim()]
+ *   data_img[n * trackSize() * imgDim() ... (n+1) * trackSize() * imgDim()]
+ * with frames in order and the values of a frame next to each other.
+ */
+class SmiDataReader {
+  pqxx::work& work_;
+  long int dataset_id_;
+
+  unsigned int size_;
+  unsigned int track_size_;
+  unsigned int int_dim_;
+  unsigned int img_dim_;
+
+public:
+  SmiDataReader(pqxx::work& work, long int dataset_id);
+
+  /* Number of rows */
+  unsigned int size() const;
+
+  /* Longest track_size of the import */
+  unsigned int trackSize() const;
+
+  unsigned int intDim() const;
+  unsigned int imgDim() const;
+
+  /* data_int and data_img must have room for size() records as described
+   * above. If data_img is NULL the images are not fetched.
+   */
+  void read(float* data_int, float* data_img,
+	    std::vector<SmiRecord>& records,
+	    ThreadPool& pool,
+	    unsigned int batch = 64);
+};
+
+#endif
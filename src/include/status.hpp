@@ -0,0 +1,36 @@
+#ifndef __STATUS_H_
+#define __STATUS_H_
+
+#include<atomic>
+#include<ostream>
+
+/* Outcome of importing one track. Rejected tracks are the normal case and
+ * are reported as a status. Exceptions are left for faults.
+ */
+enum TrackStatus {
+  TrackImported = 0,
+  TrackFiltered,		/* rejected by the FilterChain */
+  TrackTooFewLevels,		/* less than 2 levels, no track case */
+  TrackBadStructure,		/* levels do not have the L1First/L1Last shape */
+  TrackNotInGDR,		/* the step is outside the global drift ranges */
+  TrackSizeMismatch,		/* extracted data does not match the track size */
+  TrackFailed,			/* an exception was thrown */
+  TrackStatusCount
+};
+
+const char* trackStatusName(TrackStatus status);
+
+/* Number of tracks per status. Safe to use from several threads. */
+class TrackStatistics {
+  std::atomic<unsigned long> counts_[TrackStatusCount];
+
+public:
+  TrackStatistics();
+
+  void count(TrackStatus status);
+  unsigned long operator[](TrackStatus status) const;
+
+  void report(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __THREAD_POOL_H_
+#define __THREAD_POOL_H_
+
+#include<vector>
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<functional>
+#include<exception>
+
+/* Fixed set of threads running submitted tasks in order of submission. */
+class ThreadPool {
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+
+  std::mutex lock_;
+  std::condition_variable ready_;
+  std::condition_variable idle_;
+
+  unsigned int busy_;
+  bool stop_;
+  std::exception_ptr error_;
+
+  void work();
+
+public:
+  /* 0 threads means one per hardware thread */
+  explicit ThreadPool(unsigned int threads = 0);
+  ~ThreadPool();
+
+  unsigned int size() const;
+
+  void submit(std::function<void()> task);
+
+  /* Waits until all submitted tasks finished. If a task threw, the first
+   * exception is rethrown here.
+   */
+  void wait();
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __MOCK_ANALYSIS_H_
+#define __MOCK_ANALYSIS_H_
+
+#include "datamodel.hpp"
+
+namespace MSMMTracking {
+
+/* Extends the track over every frame of the stack. The new points stay at
+ * the nearest point of the track, are marked interpolated and take their
+ * counts from the image.
+ */
+void ExtrapolateTrack(MSMMDataModel::Track& track,
+		      const MSMMDataModel::ImFrameStack& frames,
+		      float spot_fwhm,
+		      float maskw,
+		      float nbar,
+		      void* progress,
+		      bool& keepgoing,
+		      int verbose,
+		      bool separate_channels);
+
+}
+
+#endif
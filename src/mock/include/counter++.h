@@ -0,0 +1,11 @@
+#ifndef __MOCK_COUNTER_H_
+#define __MOCK_COUNTER_H_
+
+namespace CppUtil {
+
+/* Progress counter of the project loader, ignored by the mock */
+class FracCounter {};
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef __MOCK_DATAMODEL_H_
+#define __MOCK_DATAMODEL_H_
+
+#include<vector>
+#include<map>
+#include<set>
+#include<string>
+#include<utility>
+
+/* The MSMM headers bring these in and the importers rely on it */
+#include<iostream>
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+#include<stdexcept>
+#include<cmath>
+
+/* Synthetic stand-in for the part of the MSMM data model the importers use.
+ * Only the names and signatures follow MSMM; the data is generated, see
+ * msmm_project.hpp.
+ */
+
+namespace MSMMProject { class Project; }
+
+namespace MSMMDataModel {
+
+typedef unsigned int TrackId;
+typedef unsigned int FrameId;
+typedef int ChId;
+
+class ChannelConfig {
+public:
+  unsigned int n() const;
+  ChId getId(unsigned int i) const;
+};
+
+class Image {
+  unsigned int width_;
+  unsigned int height_;
+  std::vector<float> pixels_;
+
+public:
+  Image(unsigned int width = 0, unsigned int height = 0);
+
+  unsigned int width() const;
+  unsigned int height() const;
+
+  /* Pixels outside the image read as the nearest pixel at the border */
+  float at(int x, int y) const;
+  float& at(int x, int y);
+};
+
+class ImFrame {
+  FrameId id_;
+  Image image_;
+
+public:
+  ImFrame(FrameId id, unsigned int width, unsigned int height);
+
+  FrameId getId() const;
+  const Image& getImage(ChId channel) const;
+  Image& getImage(ChId channel);
+};
+
+class ImFrameStack {
+  std::vector<ImFrame> frames_;
+
+public:
+  typedef std::vector<ImFrame>::const_iterator const_iterator;
+
+  void push_back(const ImFrame& frame);
+  std::size_t size() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  ImFrame& operator[](std::size_t i);
+};
+
+/* One point of a track */
+class Feature {
+  float x_;
+  float y_;
+
+public:
+  Feature(float x = 0, float y = 0);
+
+  std::map<ChId, float> counts;
+  std::map<ChId, float> sigcounts;
+  std::map<ChId, float> bg;
+  bool interp;
+
+  float getX() const;
+  float getY() const;
+};
+
+class Range {
+  int min_;
+  int max_;
+
+public:
+  Range(int min, int max);
+  int min() const;
+  int max() const;
+};
+
+class Level {
+  std::vector<Range> ranges_;
+
+public:
+  Level(const std::vector<Range>& ranges);
+
+  std::map<ChId, float> mean_counts;
+  const std::vector<Range>& get_ranges() const;
+};
+
+struct LevelOptions {
+  enum LevelDetectionVersion { Std, StepProb, NNet };
+
+  LevelOptions();
+
+  bool overwrite;
+  LevelDetectionVersion level_version;
+};
+
+class Track {
+  std::map<FrameId, Feature> points_;
+  LevelOptions level_options_;
+  std::vector<Level> levels_;
+  std::map<std::string, float> scores_;
+
+public:
+  /* Number of points */
+  std::size_t size() const;
+
+  FrameId first_frameid() const;
+  FrameId last_frameid() const;
+  FrameId first_non_interpolated_frameid() const;
+  FrameId last_non_interpolated_frameid() const;
+
+  Feature& operator[](FrameId frame);
+  const Feature& operator[](FrameId frame) const;
+  const std::map<FrameId, Feature>& points() const;
+
+  void set_level_options(const LevelOptions& options);
+
+  /* Finds the levels with the detection of the level options. The versions
+   * differ in the window they smooth the counts with.
+   */
+  void calc_scores(const ChannelConfig& cc, const ImFrameStack& frames, float spot_fwhm);
+
+  const std::vector<Level>& get_levels() const;
+
+  /* Scores not calculated by the mock are 0 */
+  float get_score(const std::string& name) const;
+};
+
+typedef std::vector<std::pair<std::string, float>> CombiScore;
+CombiScore GetCombiScore1();
+
+}
+
+#endif
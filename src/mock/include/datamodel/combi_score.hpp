@@ -0,0 +1 @@
+#include "../datamodel.hpp"
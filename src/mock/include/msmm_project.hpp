@@ -0,0 +1,58 @@
+#ifndef __MOCK_MSMM_PROJECT_H_
+#define __MOCK_MSMM_PROJECT_H_
+
+#include<string>
+#include<map>
+#include<utility>
+
+#include "datamodel.hpp"
+#include "counter++.h"
+
+namespace MSMMProject {
+
+struct Options {
+  Options();
+
+  float spot_fwhm;
+  float maskw;
+  float nbar;
+};
+
+class Stacks {
+  MSMMDataModel::ImFrameStack proc_frames_;
+
+public:
+  const MSMMDataModel::ImFrameStack& proc_frames() const;
+  MSMMDataModel::ImFrameStack& proc_frames();
+};
+
+/* A synthetic project. The path is a list of settings like
+ * "mock:tracks=1000:frames=500:size=64:seed=1"; settings left out take
+ * these defaults. The same path always gives the same project.
+ *
+ * The tracks are spots in a frames x size x size stack with a Poisson
+ * background. Each track lives for a random part of the stack and bleaches
+ * in one to three steps, so the level detection has something to find.
+ */
+class Project {
+  Options options_;
+  Stacks stacks_;
+  std::map<MSMMDataModel::TrackId, MSMMDataModel::Track> tracks_;
+  std::pair<MSMMDataModel::FrameId, MSMMDataModel::FrameId> range_;
+
+public:
+  Project(const std::string& path);
+
+  void set_counter(CppUtil::FracCounter& counter);
+
+  const Stacks& stacks() const;
+  MSMMDataModel::ChannelConfig get_channel_config() const;
+  std::pair<MSMMDataModel::FrameId, MSMMDataModel::FrameId> get_FrameId_range() const;
+  const std::map<MSMMDataModel::TrackId, MSMMDataModel::Track>& get_tracks() const;
+  const Options& get_options() const;
+  bool should_i_separate_channels() const;
+};
+
+}
+
+#endif
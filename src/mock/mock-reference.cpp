@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+
+/** Writes a reference file over synthetic projects for benchmarking the
+ *  importers built with MSMM_MOCK.
+ */
+
+
+/** It takes 3 arguments: the number of data sets, the number of tracks in
+ *  each and the number of frames in each. An optional fourth argument puts
+ *  every n-th track into the reference file, by default every track.
+ *
+ *  The data sets are "mock:tracks=<t>:frames=<f>:seed=<i>" and all tracks
+ *  get the whole data set as GDR.
+ */
+int main(int argc, char** argv) {
+
+  if (argc < 4 || argc > 5) return -1;
+
+  unsigned long datasets = std::stoul(argv[1]);
+  unsigned long tracks = std::stoul(argv[2]);
+  unsigned long frames = std::stoul(argv[3]);
+  unsigned long every = argc == 5 ? std::stoul(argv[4]) : 1;
+  if (!every) return -1;
+
+  for (unsigned long d = 0; d < datasets; d++) {
+    std::string name = "mock:tracks=" + std::to_string(tracks) +
+      ":frames=" + std::to_string(frames) + ":seed=" + std::to_string(d + 1);
+
+    for (unsigned long t = 0; t < tracks; t += every)
+      std::cout << name << "," << t << ",-1,-1" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,319 @@
+#include "datamodel.hpp"
+#include "analysis.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace MSMMDataModel {
+
+unsigned int ChannelConfig::n() const {
+  return 1;
+}
+
+ChId ChannelConfig::getId(unsigned int i) const {
+  if (i != 0) throw std::out_of_range("The mock has a single channel");
+  return 0;
+}
+
+
+Image::Image(unsigned int width, unsigned int height)
+  : width_(width), height_(height), pixels_(width * height) {}
+
+unsigned int Image::width() const {
+  return width_;
+}
+
+unsigned int Image::height() const {
+  return height_;
+}
+
+float Image::at(int x, int y) const {
+  x = std::min(std::max(x, 0), (int)width_ - 1);
+  y = std::min(std::max(y, 0), (int)height_ - 1);
+  return pixels_[y * width_ + x];
+}
+
+float& Image::at(int x, int y) {
+  x = std::min(std::max(x, 0), (int)width_ - 1);
+  y = std::min(std::max(y, 0), (int)height_ - 1);
+  return pixels_[y * width_ + x];
+}
+
+
+ImFrame::ImFrame(FrameId id, unsigned int width, unsigned int height)
+  : id_(id), image_(width, height) {}
+
+FrameId ImFrame::getId() const {
+  return id_;
+}
+
+const Image& ImFrame::getImage(ChId channel) const {
+  return image_;
+}
+
+Image& ImFrame::getImage(ChId channel) {
+  return image_;
+}
+
+
+void ImFrameStack::push_back(const ImFrame& frame) {
+  frames_.push_back(frame);
+}
+
+std::size_t ImFrameStack::size() const {
+  return frames_.size();
+}
+
+ImFrameStack::const_iterator ImFrameStack::begin() const {
+  return frames_.begin();
+}
+
+ImFrameStack::const_iterator ImFrameStack::end() const {
+  return frames_.end();
+}
+
+ImFrame& ImFrameStack::operator[](std::size_t i) {
+  return frames_[i];
+}
+
+
+Feature::Feature(float x, float y) : x_(x), y_(y), interp(false) {}
+
+float Feature::getX() const {
+  return x_;
+}
+
+float Feature::getY() const {
+  return y_;
+}
+
+
+Range::Range(int min, int max) : min_(min), max_(max) {}
+
+int Range::min() const {
+  return min_;
+}
+
+int Range::max() const {
+  return max_;
+}
+
+
+Level::Level(const std::vector<Range>& ranges) : ranges_(ranges) {}
+
+const std::vector<Range>& Level::get_ranges() const {
+  return ranges_;
+}
+
+
+LevelOptions::LevelOptions() : overwrite(false), level_version(Std) {}
+
+
+std::size_t Track::size() const {
+  return points_.size();
+}
+
+FrameId Track::first_frameid() const {
+  if (points_.empty()) throw std::runtime_error("Empty track");
+  return points_.begin()->first;
+}
+
+FrameId Track::last_frameid() const {
+  if (points_.empty()) throw std::runtime_error("Empty track");
+  return points_.rbegin()->first;
+}
+
+FrameId Track::first_non_interpolated_frameid() const {
+  for (const auto& p : points_)
+    if (!p.second.interp) return p.first;
+  return first_frameid();
+}
+
+FrameId Track::last_non_interpolated_frameid() const {
+  for (auto p = points_.rbegin(); p != points_.rend(); p++)
+    if (!p->second.interp) return p->first;
+  return last_frameid();
+}
+
+Feature& Track::operator[](FrameId frame) {
+  return points_[frame];
+}
+
+const Feature& Track::operator[](FrameId frame) const {
+  return points_.at(frame);
+}
+
+const std::map<FrameId, Feature>& Track::points() const {
+  return points_;
+}
+
+void Track::set_level_options(const LevelOptions& options) {
+  level_options_ = options;
+}
+
+/* Splits counts[begin, end) where the difference of the means on both sides
+ * is largest relative to the noise, as long as it exceeds the threshold.
+ */
+static void findSteps(const std::vector<double>& sum, const std::vector<double>& sum2,
+		      unsigned int begin, unsigned int end,
+		      unsigned int window, double threshold,
+		      std::vector<unsigned int>& steps) {
+  if (end - begin < 2 * window) return;
+
+  double n = end - begin;
+  double mean = (sum[end] - sum[begin]) / n;
+  double var = (sum2[end] - sum2[begin]) / n - mean * mean;
+  double sigma = std::sqrt(std::max(var, 1e-6));
+
+  unsigned int best = 0;
+  double best_t = threshold;
+  for (unsigned int s = begin + window; s + window <= end; s++) {
+    double left = (sum[s] - sum[begin]) / (s - begin);
+    double right = (sum[end] - sum[s]) / (end - s);
+    double t = std::fabs(left - right) / sigma *
+      std::sqrt((double)(s - begin) * (end - s) / n);
+    if (t > best_t) {
+      best_t = t;
+      best = s;
+    }
+  }
+
+  if (!best) return;
+  findSteps(sum, sum2, begin, best, window, threshold, steps);
+  steps.push_back(best);
+  findSteps(sum, sum2, best, end, window, threshold, steps);
+}
+
+void Track::calc_scores(const ChannelConfig& cc, const ImFrameStack& frames, float spot_fwhm) {
+  unsigned int window = 5;
+  double threshold = 5;
+  if (level_options_.level_version == LevelOptions::StepProb) { window = 8; threshold = 4; }
+  if (level_options_.level_version == LevelOptions::NNet) { window = 3; threshold = 6; }
+
+  ChId channel = cc.getId(0);
+  std::vector<FrameId> ids;
+  std::vector<double> sum(1, 0), sum2(1, 0);
+  unsigned int real_points = 0;
+  for (const auto& p : points_) {
+    double c = p.second.counts.at(channel);
+    ids.push_back(p.first);
+    sum.push_back(sum.back() + c);
+    sum2.push_back(sum2.back() + c * c);
+    if (!p.second.interp) real_points++;
+  }
+
+  std::vector<unsigned int> steps;
+  if (!ids.empty()) findSteps(sum, sum2, 0, ids.size(), window, threshold, steps);
+  steps.insert(steps.begin(), 0);
+  steps.push_back(ids.size());
+
+  levels_.clear();
+  std::vector<float> stdev;
+  for (unsigned int i = 0; i + 1 < steps.size() && !ids.empty(); i++) {
+    unsigned int b = steps[i], e = steps[i+1];
+    double mean = (sum[e] - sum[b]) / (e - b);
+    double var = (sum2[e] - sum2[b]) / (e - b) - mean * mean;
+
+    Level level(std::vector<Range>(1, Range(ids[b], ids[e-1])));
+    level.mean_counts[channel] = mean;
+    levels_.push_back(level);
+    stdev.push_back(std::sqrt(std::max(var, 0.0)));
+  }
+
+  scores_.clear();
+  scores_["duration"] = ids.size();
+  scores_["first_frame"] = ids.empty() ? 0 : ids.front();
+  scores_["nlevels"] = levels_.size();
+  scores_["nsteps"] = levels_.empty() ? 0 : levels_.size() - 1;
+  scores_["ratio_real_points"] = ids.empty() ? 0 : (float)real_points / ids.size();
+
+  /* Level 1 is the last one, with a single fluorophore left */
+  for (unsigned int l = 1; l <= 2 && l <= levels_.size(); l++) {
+    const Level& level = levels_[levels_.size() - l];
+    std::string n = std::to_string(l);
+    float duration = level.get_ranges()[0].max() - level.get_ranges()[0].min() + 1;
+    scores_["level" + n + "duration"] = duration;
+    scores_["level" + n + "points"] = duration;
+    scores_["cts_mean_lvl_" + n] = level.mean_counts.at(channel);
+    scores_["cts_stdev_lvl_" + n] = stdev[levels_.size() - l];
+  }
+
+  if (levels_.size() >= 2 && scores_["cts_mean_lvl_1"] != 0)
+    scores_["stepratio_lvl12"] = scores_["cts_mean_lvl_2"] / scores_["cts_mean_lvl_1"];
+}
+
+const std::vector<Level>& Track::get_levels() const {
+  return levels_;
+}
+
+float Track::get_score(const std::string& name) const {
+  auto it = scores_.find(name);
+  return it == scores_.end() ? 0 : it->second;
+}
+
+
+CombiScore GetCombiScore1() {
+  return {
+    {"nsteps", 0.5f},
+    {"stepratio_lvl12", -0.2f},
+    {"ratio_real_points", 1.0f}
+  };
+}
+
+}
+
+
+namespace MSMMTracking {
+
+void ExtrapolateTrack(MSMMDataModel::Track& track,
+		      const MSMMDataModel::ImFrameStack& frames,
+		      float spot_fwhm,
+		      float maskw,
+		      float nbar,
+		      void* progress,
+		      bool& keepgoing,
+		      int verbose,
+		      bool separate_channels) {
+  if (!track.size()) return;
+
+  MSMMDataModel::Feature first = track[track.first_frameid()];
+  MSMMDataModel::Feature last = track[track.last_frameid()];
+  MSMMDataModel::FrameId first_frameid = track.first_frameid();
+
+  int mask = std::max(1, (int)maskw / 2);
+  int ring = mask + 2;
+
+  for (const auto& frame : frames) {
+    MSMMDataModel::FrameId id = frame.getId();
+    if (track.points().count(id)) continue;
+
+    const MSMMDataModel::Feature& near = id < first_frameid ? first : last;
+    int x = std::lround(near.getX());
+    int y = std::lround(near.getY());
+    const MSMMDataModel::Image& image = frame.getImage(0);
+
+    /* Background from the border of the box, counts from the mask */
+    double bg = 0;
+    for (int i = -ring; i <= ring; i++) {
+      bg += image.at(x+i, y-ring) + image.at(x+i, y+ring);
+      bg += image.at(x-ring, y+i) + image.at(x+ring, y+i);
+    }
+    bg /= 8 * ring + 4;
+
+    double counts = 0;
+    for (int i = -mask; i <= mask; i++)
+      for (int j = -mask; j <= mask; j++)
+	counts += image.at(x+i, y+j) - bg;
+
+    double area = (2*mask + 1) * (2*mask + 1);
+    MSMMDataModel::Feature f(near.getX(), near.getY());
+    f.counts[0] = counts;
+    f.sigcounts[0] = std::sqrt(std::fabs(counts) + area * bg);
+    f.bg[0] = bg;
+    f.interp = true;
+    track[id] = f;
+  }
+}
+
+}
@@ -0,0 +1,136 @@
+#include "msmm_project.hpp"
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace MSMMProject {
+
+Options::Options() : spot_fwhm(2.5), maskw(5), nbar(2) {}
+
+const MSMMDataModel::ImFrameStack& Stacks::proc_frames() const {
+  return proc_frames_;
+}
+
+MSMMDataModel::ImFrameStack& Stacks::proc_frames() {
+  return proc_frames_;
+}
+
+/* Reads "mock:tracks=1000:frames=500" into the given settings */
+static void readSettings(const std::string& path, std::map<std::string, unsigned long>& settings) {
+  std::stringstream ss(path);
+  std::string item;
+
+  std::getline(ss, item, ':');
+  if (item != "mock")
+    throw std::runtime_error("Not a mock project " + path);
+
+  while (std::getline(ss, item, ':')) {
+    std::size_t eq = item.find('=');
+    if (eq == std::string::npos || !settings.count(item.substr(0, eq)))
+      throw std::runtime_error("Unknown mock setting " + item);
+    settings[item.substr(0, eq)] = std::stoul(item.substr(eq + 1));
+  }
+}
+
+Project::Project(const std::string& path) {
+  std::map<std::string, unsigned long> settings = {
+    {"tracks", 100}, {"frames", 500}, {"size", 64}, {"seed", 1}
+  };
+  readSettings(path, settings);
+
+  unsigned int n_tracks = settings["tracks"];
+  unsigned int n_frames = std::max(settings["frames"], 40ul);
+  int size = std::max(settings["size"], 16ul);
+  std::mt19937 random(settings["seed"]);
+
+  const float background = 100;
+  const float unit = 400;
+  const float sigma = options_.spot_fwhm / 2.355;
+  range_ = std::make_pair(1u, n_frames);
+
+  std::normal_distribution<float> noise(0, std::sqrt(background));
+  MSMMDataModel::ImFrameStack& frames = stacks_.proc_frames();
+  for (unsigned int f = 0; f < n_frames; f++) {
+    frames.push_back(MSMMDataModel::ImFrame(f + 1, size, size));
+    MSMMDataModel::Image& image = frames[f].getImage(0);
+    for (int y = 0; y < size; y++)
+      for (int x = 0; x < size; x++)
+	image.at(x, y) = background + noise(random);
+  }
+
+  std::uniform_real_distribution<float> uniform(0, 1);
+  std::normal_distribution<float> step(0, 0.3);
+
+  for (MSMMDataModel::TrackId tid = 0; tid < n_tracks; tid++) {
+    /* Lifetime, fluorophores and their bleaching times */
+    unsigned int first = 1 + uniform(random) * (n_frames - 30);
+    unsigned int last = first + 20 + uniform(random) * (n_frames - first - 20);
+    unsigned int fluorophores = 1 + uniform(random) * 3;
+
+    std::vector<unsigned int> bleach;
+    for (unsigned int i = 0; i < fluorophores; i++)
+      bleach.push_back(first + uniform(random) * (last - first + 1));
+    std::sort(bleach.begin(), bleach.end());
+    last = std::min(last, bleach.back() + 5);
+
+    float x = 4 + uniform(random) * (size - 8);
+    float y = 4 + uniform(random) * (size - 8);
+
+    MSMMDataModel::Track& track = tracks_[tid];
+    for (unsigned int f = first; f <= last; f++) {
+      x = std::min(std::max(x + step(random), 4.0f), size - 5.0f);
+      y = std::min(std::max(y + step(random), 4.0f), size - 5.0f);
+
+      unsigned int on = bleach.end() - std::upper_bound(bleach.begin(), bleach.end(), f);
+      float intensity = on * unit;
+
+      /* Draw the spot into the frame */
+      MSMMDataModel::Image& image = frames[f - 1].getImage(0);
+      for (int i = -3; i <= 3; i++)
+	for (int j = -3; j <= 3; j++) {
+	  float dx = std::round(x) + i - x, dy = std::round(y) + j - y;
+	  image.at(std::lround(x) + i, std::lround(y) + j) += intensity / (2 * M_PI * sigma * sigma) *
+	    std::exp(-(dx*dx + dy*dy) / (2 * sigma * sigma));
+	}
+
+      std::normal_distribution<float> shot(0, std::sqrt(intensity + 9 * background));
+      MSMMDataModel::Feature point(x, y);
+      point.counts[0] = intensity + shot(random);
+      point.sigcounts[0] = std::sqrt(intensity + 9 * background);
+      point.bg[0] = background;
+      point.interp = (f != first && f != last && uniform(random) < 0.02);
+      track[f] = point;
+    }
+  }
+}
+
+void Project::set_counter(CppUtil::FracCounter& counter) {}
+
+const Stacks& Project::stacks() const {
+  return stacks_;
+}
+
+MSMMDataModel::ChannelConfig Project::get_channel_config() const {
+  return MSMMDataModel::ChannelConfig();
+}
+
+std::pair<MSMMDataModel::FrameId, MSMMDataModel::FrameId> Project::get_FrameId_range() const {
+  return range_;
+}
+
+const std::map<MSMMDataModel::TrackId, MSMMDataModel::Track>& Project::get_tracks() const {
+  return tracks_;
+}
+
+const Options& Project::get_options() const {
+  return options_;
+}
+
+bool Project::should_i_separate_channels() const {
+  return false;
+}
+
+}
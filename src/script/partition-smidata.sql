@@ -0,0 +1,18 @@
+-- Turns smidata into a table partitioned by dataset_id, which the importers
+-- need for --bulk. The existing rows are kept in the default partition.
+--
+-- Indexes and primary keys stay on smidata_default. An index created on the
+-- partitioned table later is built for every attached import as well.
+--
+-- Attaching an import checks that the default partition holds no rows of
+-- its dataset_id, which reads the default partition once per attach.
+begin;
+
+alter table smidata rename to smidata_default;
+
+create table smidata (like smidata_default including defaults)
+  partition by list (dataset_id);
+
+alter table smidata attach partition smidata_default default;
+
+commit;
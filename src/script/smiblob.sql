@@ -0,0 +1,23 @@
+-- Content addressed storage of the track payloads, which the importers need
+-- for --payload blob. The rows imported with --payload blob leave data_int
+-- and data_img empty and refer to smiblob by hash instead.
+--
+-- The check recomputes the hash of every new blob, so a client hashing
+-- differently cannot store a payload under a wrong name.
+begin;
+
+create table if not exists smiblob (
+  hash text primary key,
+  data text not null,
+  check (hash = encode(sha256(convert_to(data, 'UTF8')), 'hex'))
+);
+
+alter table smidata add column if not exists data_int_hash text;
+alter table smidata add column if not exists data_img_hash text;
+
+commit;
+
+-- The blobs no import refers to any more can be removed with
+--
+-- delete from smiblob b where not exists
+--   (select 1 from smidata s where s.data_int_hash = b.hash or s.data_img_hash = b.hash);
@@ -0,0 +1,41 @@
+#include "options.hpp"
+#include "selections.hpp"
+#include "thread_pool.hpp"
+
+#include <iostream>
+
+/** Writes the reference file of the manually selected tracks to stdout. It
+ *  replaces extract_track_selections/extract_selections.sh.
+ */
+
+
+/** It takes 1 argument, the prefix of the selection file names. An optional
+ *  second argument is the directory searched for selection files, by default
+ *  the user data of the nano browser.
+ *
+ *  Optional arguments:
+ *  * --jobs <n> reads n directories or files at the same time, by default
+ *    one per hardware thread. The share answers slowly, so more jobs than
+ *    cores pay off.
+ */
+int main(int argc, char** argv) {
+
+  Options opts(argc, argv);
+  if (opts.args().size() < 1) return -1;
+  if (opts.args().size() > 2) return -1;
+
+  std::string prefix(opts.args()[0]);
+  std::string root("/mnt/rclsfserv005/MSMM_nano/user_data/");
+  if (opts.args().size() == 2) root = opts.args()[1];
+
+  ThreadPool pool(std::stoi(opts.get("jobs", "0")));
+
+  std::vector<std::string> files = findSelections(root, prefix, pool);
+  std::vector<ReferenceRecord> records = readSelections(files, pool);
+
+  for (const auto& r : records)
+    std::cout << std::get<0>(r) << "," << std::get<1>(r) << ","
+	      << std::get<2>(r) << "," << std::get<3>(r) << std::endl;
+
+  return 0;
+}
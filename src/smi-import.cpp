@@ -0,0 +1,95 @@
+#include "options.hpp"
+#include "engine.hpp"
+#include "sinks.hpp"
+
+/** Imports tracks from hdf5 format into several outputs at once. Each
+ *  project is loaded and each track extrapolated only once for all of them.
+ */
+
+
+/** It takes 1 argument, the reference file with source data sets and source
+ *  track ids as smi-db-import-classification takes it.
+ *
+ *  Outputs, at least one is required:
+ *  * --classification <info> the records of smi-db-import-classification
+ *    in a new data set with the given description.
+ *  * --level-detection <info> the records of smi-db-import-level-detection
+ *    in a new data set with the given description.
+ *  * --csv <directory> the files of smi-csv-import-all-tracks, in a
+ *    directory per data set at the path of the data set.
+ *  * --hdf5 <file> the frame data of every track in one HDF5 file.
+ *
+ *  Each output takes its own --<output>-filters <list>, see FilterChain. The
+ *  defaults are those of the single importers: "min-length:20,levels:2,gdr"
+ *  for classification and all tracks for the others.
+ *
+ *  --shard, --shard-cost, --stats, --jobs, --memory-budget, --bulk and
+ *  --payload are as for smi-db-import-classification. --dataset-id may be
+ *  given only with a single database output.
+ *
+ *  The ids of the new data sets are printed as "<output> <id>".
+ */
+int main(int argc, char** argv) {
+
+  Options opts(argc, argv);
+  if (opts.args().size() != 1) return -1;
+
+  std::string reference_file(opts.args()[0]);
+
+  if (opts.has("dataset-id") && opts.has("classification") && opts.has("level-detection"))
+    throw std::runtime_error("--dataset-id needs a single database output");
+
+  ImportEngine engine;
+
+  try {
+    engine.addReference(reference_file);
+  } catch (const std::runtime_error& e) {
+    std::cerr << "Error reading file " << reference_file << std::endl;
+    std::cerr << "Error message: " << e.what() << std::endl;
+    return -1;
+  }
+
+  std::unique_ptr<ClassificationSink> classification;
+  std::unique_ptr<LevelDetectionSink> level_detection;
+  std::unique_ptr<CsvSink> csv;
+  std::unique_ptr<Hdf5Sink> hdf5;
+
+  if (opts.has("classification")) {
+    classification.reset(new ClassificationSink(opts, opts.get("classification"),
+						opts.get("classification-filters",
+							 "min-length:20,levels:2,gdr")));
+    engine.addSink(*classification);
+  }
+
+  if (opts.has("level-detection")) {
+    level_detection.reset(new LevelDetectionSink(opts, opts.get("level-detection"),
+						 opts.get("level-detection-filters", "")));
+    engine.addSink(*level_detection);
+  }
+
+  if (opts.has("csv")) {
+    csv.reset(new CsvSink(opts.get("csv"), true, opts.get("csv-filters", "")));
+    engine.addSink(*csv);
+  }
+
+  if (opts.has("hdf5")) {
+    hdf5.reset(new Hdf5Sink(opts.get("hdf5"), opts.get("hdf5-filters", "")));
+    engine.addSink(*hdf5);
+  }
+
+  if (!classification && !level_detection && !csv && !hdf5) return -1;
+
+  engine.run(opts);
+
+  for (TrackSink* sink : std::vector<TrackSink*>{classification.get(), level_detection.get(),
+						   csv.get(), hdf5.get()}) {
+    if (!sink) continue;
+    std::cerr << sink->name() << ":" << std::endl;
+    sink->report(std::cerr);
+  }
+
+  if (classification) std::cout << "classification " << classification->target().id() << std::endl;
+  if (level_detection) std::cout << "level-detection " << level_detection->target().id() << std::endl;
+
+  return 0;
+}
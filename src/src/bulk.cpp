@@ -0,0 +1,31 @@
+#include "bulk.hpp"
+
+std::string smidataPartition(long int dataset_id) {
+  return "smidata_" + std::to_string(dataset_id);
+}
+
+void createSmidataPartition(pqxx::work& w, long int dataset_id) {
+  std::string table = smidataPartition(dataset_id);
+
+  /* Only defaults, the indexes are built once the data is loaded */
+  w.exec("create table if not exists " + table +
+	 " (like smidata including defaults)");
+}
+
+void attachSmidataPartition(pqxx::work& w, long int dataset_id) {
+  std::string table = smidataPartition(dataset_id);
+  std::string id = std::to_string(dataset_id);
+
+  w.exec("create index if not exists " + table + "_track on " + table +
+	 " (source_data_set, source_track_id)");
+
+  /* With the constraint in place attaching does not scan the table again */
+  w.exec("alter table " + table + " add constraint " + table + "_dataset_id"
+	 " check (dataset_id = " + id + ")");
+
+  w.exec("alter table smidata attach partition " + table +
+	 " for values in (" + id + ")");
+
+  w.exec("alter table " + table + " drop constraint " + table + "_dataset_id");
+  w.exec("analyze " + table);
+}
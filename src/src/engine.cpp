@@ -0,0 +1,259 @@
+#include "engine.hpp"
+#include "helpers.hpp"
+#include "io.hpp"
+#include "shard.hpp"
+#include "scheduler.hpp"
+
+#include <counter++.h>
+#include <datamodel/frames.hpp>
+#include <analysis.hpp>
+
+#include <stdexcept>
+
+const unsigned int TrackData::IntDim;
+const unsigned int TrackData::ImageCutSize;
+const unsigned int TrackData::ImgDim;
+
+TrackData::TrackData(const DatasetContext& dataset,
+		     MSMMDataModel::TrackId tid,
+		     const MSMMDataModel::Track& track)
+  : dataset_(dataset), tid_(tid), track_(track), extracted_(false) {}
+
+const DatasetContext& TrackData::dataset() const {
+  return dataset_;
+}
+
+MSMMDataModel::TrackId TrackData::tid() const {
+  return tid_;
+}
+
+const MSMMDataModel::Track& TrackData::track() const {
+  return track_;
+}
+
+unsigned int TrackData::category() const {
+  return trackLabel(dataset_.positive_tids, tid_);
+}
+
+TrackContext TrackData::context(const MSMMDataModel::Track& track,
+				 std::string* track_case) const {
+  return {tid_, track, dataset_.positive_tids, dataset_.gdrs, dataset_.project, track_case};
+}
+
+unsigned int TrackData::trackSize() const {
+  return dataset_.last_frameid - dataset_.first_frameid + 1;
+}
+
+void TrackData::extract() {
+  if (error_) std::rethrow_exception(error_);
+  if (extracted_) return;
+
+  try {
+    const MSMMProject::Project& project = dataset_.project;
+    MSMMDataModel::ChId channel_id = dataset_.channel_id;
+
+    extrapolated_ = track_;
+
+    bool keepgoing = true;
+    MSMMTracking::ExtrapolateTrack(extrapolated_,
+				   dataset_.frames,
+				   project.get_options().spot_fwhm,
+				   project.get_options().maskw,
+				   project.get_options().nbar,
+				   NULL,
+				   keepgoing,
+				   0,
+				   project.should_i_separate_channels());
+
+    data_int_.reserve(trackSize() * IntDim);
+    data_img_.reserve(trackSize() * ImgDim);
+
+    for (auto frame_it = dataset_.frames.begin(); frame_it != dataset_.frames.end(); frame_it++) {
+      MSMMDataModel::FrameId frame_id = frame_it->getId();
+      if (frame_id < extrapolated_.first_frameid()) continue;
+      if (frame_id > extrapolated_.last_frameid()) break;
+
+      const auto& point = extrapolated_[frame_id];
+      data_int_.push_back(frame_id);
+      data_int_.push_back(point.counts.at(channel_id));
+      data_int_.push_back(point.sigcounts.at(channel_id));
+      data_int_.push_back(point.getX());
+      data_int_.push_back(point.getY());
+      data_int_.push_back(point.bg.at(channel_id));
+      data_int_.push_back(point.interp);
+
+      float x = point.getX();
+      float y = point.getY();
+
+      // Copy the image around the feature and represent it as vector.
+      const int cut = ImageCutSize;
+      for (int i = -cut; i <= cut; i++)
+	for (int j = -cut; j <= cut; j++)
+	  data_img_.push_back(frame_it->getImage(channel_id).at(x+i, y+j));
+    }
+  } catch (...) {
+    error_ = std::current_exception();
+    throw;
+  }
+
+  extracted_ = true;
+}
+
+const MSMMDataModel::Track& TrackData::extrapolated() {
+  extract();
+  return extrapolated_;
+}
+
+const std::vector<float>& TrackData::dataInt() {
+  extract();
+  return data_int_;
+}
+
+const std::vector<float>& TrackData::dataImg() {
+  extract();
+  return data_img_;
+}
+
+unsigned int TrackData::frames() {
+  extract();
+  return data_int_.size() / IntDim;
+}
+
+bool TrackData::complete() {
+  extract();
+  return data_int_.size() == trackSize() * IntDim &&
+    data_img_.size() == trackSize() * ImgDim;
+}
+
+
+DatasetWriter::~DatasetWriter() {}
+
+void DatasetWriter::close() {}
+
+
+TrackSink::TrackSink(const std::string& filters) : filters_(filters) {}
+
+TrackSink::~TrackSink() {}
+
+void TrackSink::finish() {}
+
+FilterChain& TrackSink::filters() {
+  return filters_;
+}
+
+TrackStatistics& TrackSink::statistics() {
+  return stats_;
+}
+
+void TrackSink::report(std::ostream& out) const {
+  filters_.report(out);
+  stats_.report(out);
+}
+
+
+void ImportEngine::addReference(const std::string& reference_file) {
+  std::vector<std::tuple<std::string, unsigned int, int, int>> import_data;
+  readCSV(reference_file, import_data);
+
+  for (const auto& t : import_data) {
+    datasets_tracks_[std::get<0>(t)].push_back(std::get<1>(t));
+    datasets_gdrs_[std::get<0>(t)].insert(std::make_pair(std::get<2>(t), std::get<3>(t)));
+  }
+}
+
+void ImportEngine::addDataset(const std::string& source_data_set) {
+  datasets_tracks_[source_data_set];
+  datasets_gdrs_[source_data_set];
+}
+
+void ImportEngine::addSink(TrackSink& sink) {
+  sinks_.push_back(&sink);
+}
+
+void ImportEngine::import(const std::string& source_data_set, const Options& opts) {
+  const std::vector<unsigned int>& positive_tids = datasets_tracks_.at(source_data_set);
+
+  // Prepare the project
+  CppUtil::FracCounter counter;
+
+  std::unique_lock<std::mutex> load(projectLoadLock());
+  MSMMProject::Project project(source_data_set);
+  project.set_counter(counter);
+
+  const MSMMDataModel::ImFrameStack& frames = project.stacks().proc_frames();
+  load.unlock();
+
+  /* The project closes its files when it goes out of scope, which must hold
+   * the lock as well, also when the import throws. The writers are declared
+   * later and so are closed before the lock is taken. */
+  struct Relock {
+    std::unique_lock<std::mutex>& load;
+    ~Relock() { load.lock(); }
+  } relock = {load};
+
+  MSMMDataModel::ChannelConfig cc = project.get_channel_config();
+  if (cc.n() != 1)
+    throw std::runtime_error("Number of channels different from 1");
+
+  unsigned int first_frameid = project.get_FrameId_range().first;
+  unsigned int last_frameid = project.get_FrameId_range().second;
+
+  if (opts.has("stats"))
+    writeShardStats(opts.get("stats"), source_data_set,
+		    last_frameid - first_frameid + 1, project.get_tracks().size());
+
+  /* If there is at least one track with has GDR the who data set (-1, -1)
+   * set the global drift ranges for that data set to the entire duration
+   * of the data set
+   */
+  std::set<std::pair<int,int>> gdrs = datasets_gdrs_.at(source_data_set);
+  if (gdrs.count(std::make_pair(-1, -1))) {
+    gdrs.clear();
+    gdrs.insert(std::make_pair((int)first_frameid, (int)last_frameid));
+  }
+
+  DatasetContext d = {source_data_set, project, frames, cc, cc.getId(0),
+		      first_frameid, last_frameid, positive_tids, gdrs};
+
+  std::vector<std::unique_ptr<DatasetWriter>> writers;
+  for (TrackSink* sink : sinks_) writers.push_back(sink->open(d));
+
+  /* Process each track in the project */
+  for (const auto& tid_track : project.get_tracks()) {
+    TrackData t(d, tid_track.first, tid_track.second);
+
+    for (unsigned int i = 0; i < sinks_.size(); i++) {
+      /* Reject what we can before the track is copied */
+      TrackStatus status = sinks_[i]->filters().check(t.context(t.track()),
+						       FilterChain::BeforeLevels);
+      if (status == TrackImported) status = writers[i]->write(t);
+
+      sinks_[i]->statistics().count(status);
+    }
+  }
+
+  for (auto& writer : writers) writer->close();
+  writers.clear();
+}
+
+void ImportEngine::run(const Options& opts) {
+  std::vector<std::string> datasets;
+  for (const auto& d : datasets_tracks_) datasets.push_back(d.first);
+
+  if (opts.has("shard")) {
+    std::map<std::string, double> costs;
+    if (opts.has("shard-cost")) costs = readShardCosts(opts.get("shard-cost"));
+
+    std::set<std::string> selected = shardDatasets(datasets, parseShard(opts.get("shard")), costs);
+    datasets.assign(selected.begin(), selected.end());
+  }
+
+  unsigned int jobs = std::stoi(opts.get("jobs", "1"));
+  MemoryBudget budget(std::stod(opts.get("memory-budget", "0")) * (1ULL << 30));
+
+  scheduleDatasets(datasets, jobs, budget, [&](const std::string& source_data_set) {
+      import(source_data_set, opts);
+    });
+
+  for (TrackSink* sink : sinks_) sink->finish();
+}
@@ -0,0 +1,122 @@
+#include "filters.hpp"
+#include "helpers.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+TrackFilter::~TrackFilter() {}
+
+
+MinLengthFilter::MinLengthFilter(unsigned int length)
+  : length_(length) {}
+
+std::string MinLengthFilter::name() const {
+  return "min-length";
+}
+
+TrackFilter::Cost MinLengthFilter::cost() const {
+  return Length;
+}
+
+TrackStatus MinLengthFilter::check(const TrackContext& t) const {
+  return t.track.size() >= length_ ? TrackImported : TrackFiltered;
+}
+
+
+CategoryFilter::CategoryFilter(unsigned int category)
+  : category_(category) {}
+
+std::string CategoryFilter::name() const {
+  return "category";
+}
+
+TrackFilter::Cost CategoryFilter::cost() const {
+  return Label;
+}
+
+TrackStatus CategoryFilter::check(const TrackContext& t) const {
+  return trackLabel(t.positive_tids, t.tid) == category_ ? TrackImported : TrackFiltered;
+}
+
+
+LevelCountFilter::LevelCountFilter(unsigned int levels)
+  : levels_(levels) {}
+
+std::string LevelCountFilter::name() const {
+  return "levels";
+}
+
+TrackFilter::Cost LevelCountFilter::cost() const {
+  return Levels;
+}
+
+TrackStatus LevelCountFilter::check(const TrackContext& t) const {
+  return t.track.get_levels().size() >= levels_ ? TrackImported : TrackTooFewLevels;
+}
+
+
+std::string GDRFilter::name() const {
+  return "gdr";
+}
+
+TrackFilter::Cost GDRFilter::cost() const {
+  return TrackCase;
+}
+
+TrackStatus GDRFilter::check(const TrackContext& t) const {
+  std::string track_case;
+  return getTrackCase(t.track, t.project, t.gdrs, t.track_case ? *t.track_case : track_case);
+}
+
+
+FilterChain::FilterChain(const std::string& spec) {
+  std::stringstream spec_ss(spec);
+  std::string item;
+
+  while (std::getline(spec_ss, item, ',')) {
+    if (item.empty()) continue;
+
+    std::string name = item.substr(0, item.find(':'));
+    std::string arg = item.find(':') == std::string::npos ? "" : item.substr(item.find(':') + 1);
+
+    if (name == "min-length" && !arg.empty())
+      filters_.emplace_back(new MinLengthFilter(std::stoul(arg)));
+    else if (name == "category" && !arg.empty())
+      filters_.emplace_back(new CategoryFilter(std::stoul(arg)));
+    else if (name == "levels" && !arg.empty())
+      filters_.emplace_back(new LevelCountFilter(std::stoul(arg)));
+    else if (name == "gdr" && arg.empty())
+      filters_.emplace_back(new GDRFilter());
+    else
+      throw std::runtime_error("Unknown filter " + item);
+  }
+
+  std::stable_sort(filters_.begin(), filters_.end(),
+		   [](const std::unique_ptr<TrackFilter>& l,
+		      const std::unique_ptr<TrackFilter>& r) {
+		     return l->cost() < r->cost();
+		   });
+
+  rejected_.reset(new std::atomic<unsigned long>[filters_.size()]);
+  for (unsigned int i = 0; i < filters_.size(); i++) rejected_[i] = 0;
+}
+
+TrackStatus FilterChain::check(const TrackContext& t, Stage stage) {
+  for (unsigned int i = 0; i < filters_.size(); i++) {
+    bool before_levels = filters_[i]->cost() < TrackFilter::Levels;
+    if (before_levels != (stage == BeforeLevels)) continue;
+
+    TrackStatus status = filters_[i]->check(t);
+    if (status != TrackImported) {
+      rejected_[i]++;
+      return status;
+    }
+  }
+  return TrackImported;
+}
+
+void FilterChain::report(std::ostream& out) const {
+  for (unsigned int i = 0; i < filters_.size(); i++)
+    out << "rejected by " << filters_[i]->name() << ": " << rejected_[i] << std::endl;
+}
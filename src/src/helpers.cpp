@@ -3,6 +3,56 @@
 #include <datamodel.hpp>
 #include <msmm_project.hpp>
 
+std::vector<std::string> exported_scores =  {
+  "change_probability",
+  "duration",
+  "first_frame",
+  "fragmentation",
+  "level1duration",
+  "level1points",
+  "level2duration",
+  "level2points",
+  "leveliness",
+  "longest_range",
+  "nlevels",
+  "nsteps",
+  "ratio_real_points",
+  "sec_longest",
+  "sec_most_pts",
+  "shortest_range",
+  "stepness",
+  "count_sigma_mls_12",
+  "cts_loc_sn_l1",
+  "cts_loc_sn_l2",
+  "cts_slm_l1",
+  "cts_slm_l2",
+  "cts_stdev_lvl_1",
+  "cts_stdev_lvl_2",
+  "distinctiveness",
+  "levelrchisq",
+  "maxovermlsig",
+  "maxstepfrac",
+  "maxstepprob",
+  "meanlocalsigmacounts_1",
+  "meanovermlsig",
+  "sigmacounts_1",
+  "significance",
+  "sigovermlsig",
+  "stepratio_lvl12",
+  "displacement",
+  "dr12",
+  "pos_density_12",
+  "pos_error_1",
+  "pos_error_2",
+  "pos_sigma_mls_12",
+  "pos_sigma_locmean_12",
+  "semdr12",
+  "sigdr12",
+  "total_pos_density",
+  "cts_mean_lvl_1",
+  "cts_mean_lvl_2"
+};
+
 unsigned int trackLabel(const std::vector<unsigned int>& labels, unsigned int l) {
   return !(std::find(labels.begin(), labels.end(), l)== labels.end());
 }
@@ -137,9 +187,10 @@ std::string getScores(MSMMDataModel::Track track,
   return scores_ss.str();
 }
 
-std::string getTrackCase( const MSMMDataModel::Track& track,
+TrackStatus getTrackCase( const MSMMDataModel::Track& track,
 			  const MSMMProject::Project& project,
-			  const std::set<std::pair<int,int>> gdrs) {
+			  const std::set<std::pair<int,int>>& gdrs,
+			  std::string& track_case) {
   unsigned int first_frameid = project.get_FrameId_range().first;
   unsigned int last_frameid = project.get_FrameId_range().second;
 
@@ -148,6 +199,8 @@ std::string getTrackCase( const MSMMDataModel::Track& track,
     throw std::runtime_error("Number of channels different from 1");
   MSMMDataModel::ChId channel_id = cc.getId(0);
 
+  if (track.get_levels().size() < 2) return TrackTooFewLevels;
+
   std::vector<std::pair<std::vector<std::pair<int, int>>, float>> lvls;
 
 
@@ -156,6 +209,7 @@ std::string getTrackCase( const MSMMDataModel::Track& track,
     for (const auto& r : lvl.get_ranges()) {
       ranges.push_back(std::make_pair(r.min(), r.max()));
     }
+    if (ranges.empty()) return TrackBadStructure;
     lvls.push_back(std::make_pair(ranges, lvl.mean_counts.at(channel_id)));
   }
 
@@ -177,8 +231,9 @@ std::string getTrackCase( const MSMMDataModel::Track& track,
       lvls[lvls.size() - 1].second < lvls[lvls.size() - 2].second) {
     
     MSMMDataModel::FrameId step = lvls[lvls.size() -2].first.back().second;
-    if (!trackInGDR(gdrs,  step - 10, step + 10)) throw std::runtime_error("track not in GDR");
-    return "L1Last";
+    if (!trackInGDR(gdrs,  step - 10, step + 10)) return TrackNotInGDR;
+    track_case = "L1Last";
+    return TrackImported;
   }
 
 
@@ -186,9 +241,10 @@ std::string getTrackCase( const MSMMDataModel::Track& track,
       lvls[0].second < lvls[1].second) {
 
     MSMMDataModel::FrameId step = lvls[1].first.front().first;
-    if (!trackInGDR(gdrs,  step - 10, step + 10)) throw std::runtime_error("track not in GDR");
-    return "L1First";
+    if (!trackInGDR(gdrs,  step - 10, step + 10)) return TrackNotInGDR;
+    track_case = "L1First";
+    return TrackImported;
   }
 
-  throw std::runtime_error("Bad structure");
+  return TrackBadStructure;
 }
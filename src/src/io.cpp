@@ -63,3 +63,28 @@ std::string base64_decode(const ::std::string &ascdata) {
   return retval;
 }
 
+
+std::size_t base64_decode(const char* ascdata, std::size_t len,
+			  unsigned char* out, std::size_t capacity) {
+  std::size_t outpos = 0;
+  int bits_collected = 0;
+  unsigned int accumulator = 0;
+
+  for (std::size_t i = 0; i < len; i++) {
+    const int c = (unsigned char)ascdata[i];
+    if (::std::isspace(c) || c == '=') continue;
+
+    if ((c > 127) || (reverse_table[c] > 63)) {
+      throw ::std::invalid_argument("This contains characters not legal in a base64 encoded string.");
+    }
+    accumulator = (accumulator << 6) | reverse_table[c];
+    bits_collected += 6;
+    if (bits_collected >= 8) {
+      bits_collected -= 8;
+      if (outpos == capacity)
+	throw ::std::length_error("Decoded base64 does not fit into the buffer.");
+      out[outpos++] = static_cast<unsigned char>((accumulator >> bits_collected) & 0xffu);
+    }
+  }
+  return outpos;
+}
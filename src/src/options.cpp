@@ -0,0 +1,40 @@
+#include "options.hpp"
+
+#include <stdexcept>
+
+Options::Options(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+
+    if (arg.compare(0, 2, "--") != 0) {
+      args_.push_back(arg);
+      continue;
+    }
+
+    if (i + 1 >= argc)
+      throw std::runtime_error("Missing value for option " + arg);
+
+    flags_[arg.substr(2)] = argv[++i];
+  }
+}
+
+const std::vector<std::string>& Options::args() const {
+  return args_;
+}
+
+bool Options::has(const std::string& name) const {
+  return flags_.count(name);
+}
+
+std::string Options::get(const std::string& name) const {
+  auto it = flags_.find(name);
+  if (it == flags_.end())
+    throw std::runtime_error("Missing option --" + name);
+  return it->second;
+}
+
+std::string Options::get(const std::string& name, const std::string& def) const {
+  auto it = flags_.find(name);
+  if (it == flags_.end()) return def;
+  return it->second;
+}
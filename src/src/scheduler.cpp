@@ -0,0 +1,142 @@
+#include "scheduler.hpp"
+
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <hdf5.h>
+
+MemoryBudget::MemoryBudget(unsigned long long budget)
+  : budget_(budget), in_flight_(0) {}
+
+void MemoryBudget::acquire(unsigned long long bytes) {
+  std::unique_lock<std::mutex> l(lock_);
+  if (!budget_) return;
+
+  released_.wait(l, [=]() {
+      return in_flight_ == 0 || in_flight_ + bytes <= budget_;
+    });
+  in_flight_ += bytes;
+}
+
+void MemoryBudget::release(unsigned long long bytes) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    if (!budget_) return;
+    in_flight_ -= std::min(bytes, in_flight_);
+  }
+  released_.notify_all();
+}
+
+
+static herr_t addDatasetSize(hid_t group, const char* name,
+			     const H5L_info_t* info, void* op_data) {
+  if (info->type != H5L_TYPE_HARD) return 0;
+
+  hid_t obj = H5Oopen(group, name, H5P_DEFAULT);
+  if (obj < 0) return 0;
+
+  if (H5Iget_type(obj) == H5I_DATASET) {
+    hid_t space = H5Dget_space(obj);
+    hid_t type = H5Dget_type(obj);
+    hssize_t n = H5Sget_simple_extent_npoints(space);
+    size_t elem = std::max(H5Tget_size(type), sizeof(float));
+
+    if (n > 0) *(unsigned long long*)op_data += (unsigned long long)n * elem;
+
+    H5Tclose(type);
+    H5Sclose(space);
+  }
+
+  H5Oclose(obj);
+  return 0;
+}
+
+static void estimatePath(const std::string& path,
+			 unsigned long long& hdf5_bytes,
+			 unsigned long long& disk_bytes) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return;
+
+  if (S_ISDIR(st.st_mode)) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return;
+
+    while (struct dirent* entry = readdir(dir)) {
+      std::string name(entry->d_name);
+      if (name == "." || name == "..") continue;
+      estimatePath(path + "/" + name, hdf5_bytes, disk_bytes);
+    }
+    closedir(dir);
+    return;
+  }
+
+  disk_bytes += st.st_size;
+  if (H5Fis_hdf5(path.c_str()) <= 0) return;
+
+  hid_t file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (file < 0) return;
+
+  H5Lvisit(file, H5_INDEX_NAME, H5_ITER_NATIVE, addDatasetSize, &hdf5_bytes);
+  H5Fclose(file);
+}
+
+std::mutex& projectLoadLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+unsigned long long estimateProjectFootprint(const std::string& path) {
+  unsigned long long hdf5_bytes = 0;
+  unsigned long long disk_bytes = 0;
+
+  std::lock_guard<std::mutex> l(projectLoadLock());
+  /* Missing files are not an error here, loading the project will report it */
+  H5E_BEGIN_TRY {
+    estimatePath(path, hdf5_bytes, disk_bytes);
+  } H5E_END_TRY;
+
+  return hdf5_bytes ? hdf5_bytes : disk_bytes;
+}
+
+
+void scheduleDatasets(const std::vector<std::string>& datasets,
+		      unsigned int jobs,
+		      MemoryBudget& budget,
+		      std::function<void(const std::string&)> process) {
+  std::atomic<unsigned int> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex error_lock;
+
+  auto worker = [&]() {
+    for (unsigned int i = next++; i < datasets.size() && !failed; i = next++) {
+      unsigned long long bytes = 0;
+      if (budget.enabled()) {
+	bytes = estimateProjectFootprint(datasets[i]);
+	budget.acquire(bytes);
+      }
+
+      try {
+	process(datasets[i]);
+      } catch (...) {
+	std::lock_guard<std::mutex> l(error_lock);
+	if (!error) error = std::current_exception();
+	failed = true;
+      }
+
+      if (budget.enabled()) budget.release(bytes);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int j = 1; j < std::max(jobs, 1u); j++)
+    threads.push_back(std::thread(worker));
+  worker();
+
+  for (auto& t : threads) t.join();
+  if (error) std::rethrow_exception(error);
+}
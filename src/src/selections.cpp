@@ -0,0 +1,133 @@
+#include "selections.hpp"
+#include "io.hpp"
+
+#include <regex>
+#include <mutex>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+/* Reads one directory and queues its subdirectories on the pool */
+static void walkDirectory(const std::string& path,
+			  const std::string& prefix,
+			  ThreadPool& pool,
+			  std::mutex& lock,
+			  std::vector<std::string>& files) {
+  DIR* dir = opendir(path.c_str());
+  if (!dir) return;
+
+  std::vector<std::string> found;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name == "." || name == "..") continue;
+
+    std::string full = path + "/" + name;
+    unsigned char type = entry->d_type;
+    if (type == DT_UNKNOWN) {
+      struct stat st;
+      if (lstat(full.c_str(), &st) != 0) continue;
+      if (S_ISDIR(st.st_mode)) type = DT_DIR;
+      else if (S_ISREG(st.st_mode)) type = DT_REG;
+    }
+
+    if (type == DT_DIR) {
+      pool.submit([full, &prefix, &pool, &lock, &files]() {
+	  walkDirectory(full, prefix, pool, lock, files);
+	});
+      continue;
+    }
+
+    if (name.size() >= prefix.size() + 4 &&
+	name.compare(0, prefix.size(), prefix) == 0 &&
+	name.compare(name.size() - 4, 4, ".csv") == 0)
+      found.push_back(full);
+  }
+  closedir(dir);
+
+  std::lock_guard<std::mutex> l(lock);
+  files.insert(files.end(), found.begin(), found.end());
+}
+
+std::vector<std::string> findSelections(const std::string& root,
+					const std::string& prefix,
+					ThreadPool& pool) {
+  std::vector<std::string> files;
+  std::mutex lock;
+
+  std::string path = root;
+  while (path.size() > 1 && path.back() == '/') path.pop_back();
+
+  pool.submit([&]() { walkDirectory(path, prefix, pool, lock, files); });
+  pool.wait();
+
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool parseSelection(const std::string& line, ReferenceRecord& record) {
+  static const std::regex mark(",*x,*[0-9]*,[0-9]*,,,");
+
+  if (line.empty() || line[0] != '/') return false;
+
+  std::string track = line;
+  if (track.back() == '\r') track.pop_back();
+  track = std::regex_replace(track, mark, "", std::regex_constants::format_first_only);
+
+  std::vector<std::string> columns;
+  std::stringstream linestream(track);
+  while (linestream.good()) {
+    std::string token;
+    std::getline(linestream, token, ',');
+    columns.push_back(token);
+  }
+
+  /* Some files leave the GDR columns empty instead of leaving them out */
+  while (columns.size() > 2 && columns.back().empty()) columns.pop_back();
+
+  if (columns.size() == 2) {
+    columns.push_back("-1");
+    columns.push_back("-1");
+  }
+
+  /* The CSV reader does not notice a malformed number */
+  if (columns.size() < 4) throw std::runtime_error("Missing GDR");
+  for (unsigned int i = 1; i < 4; i++) {
+    std::size_t end = 0;
+    try { std::stol(columns[i], &end); } catch (const std::exception&) {}
+    if (end == 0 || end != columns[i].size())
+      throw std::runtime_error("Bad number " + columns[i]);
+  }
+
+  CSVReader<std::string, unsigned int, int, int> reader(record);
+  reader.readCSVLine(columns);
+  return true;
+}
+
+std::vector<ReferenceRecord> readSelections(const std::vector<std::string>& files,
+					    ThreadPool& pool) {
+  std::vector<std::vector<ReferenceRecord>> records(files.size());
+
+  for (unsigned int i = 0; i < files.size(); i++) {
+    pool.submit([i, &files, &records]() {
+	std::ifstream csv(files[i]);
+	std::string line;
+
+	while (std::getline(csv, line)) {
+	  ReferenceRecord record;
+	  try {
+	    if (parseSelection(line, record)) records[i].push_back(record);
+	  } catch (const std::runtime_error& e) {
+	    std::cerr << files[i] << ": " << e.what() << ": " << line << std::endl;
+	  }
+	}
+      });
+  }
+  pool.wait();
+
+  std::vector<ReferenceRecord> all;
+  for (const auto& r : records) all.insert(all.end(), r.begin(), r.end());
+  return all;
+}
@@ -0,0 +1,91 @@
+#include "shard.hpp"
+#include "io.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <mutex>
+
+Shard parseShard(const std::string& spec) {
+  Shard shard;
+  char sep = 0;
+  std::stringstream ss(spec);
+
+  ss >> shard.index >> sep >> shard.count;
+  if (ss.fail() || !ss.eof() || sep != '/' ||
+      shard.count == 0 || shard.index == 0 || shard.index > shard.count)
+    throw std::runtime_error("Bad shard " + spec + ", expected i/N with 1 <= i <= N");
+
+  return shard;
+}
+
+unsigned long long stableHash(const std::string& s) {
+  unsigned long long h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+std::map<std::string, double> readShardCosts(const std::string& fname) {
+  std::vector<std::tuple<std::string, unsigned int, unsigned int>> stats;
+  readCSV(fname, stats);
+
+  std::map<std::string, double> costs;
+  for (const auto& s : stats)
+    costs[std::get<0>(s)] = (double)std::get<1>(s) * std::get<2>(s);
+
+  return costs;
+}
+
+void writeShardStats(const std::string& fname,
+		     const std::string& dataset,
+		     unsigned int frames,
+		     unsigned int tracks) {
+  /* The importers load projects on several threads */
+  static std::mutex lock;
+  std::lock_guard<std::mutex> l(lock);
+
+  std::ofstream out(fname, std::ios::app);
+  out << dataset << "," << frames << "," << tracks << std::endl;
+}
+
+std::set<std::string> shardDatasets(const std::vector<std::string>& datasets,
+				    const Shard& shard,
+				    const std::map<std::string, double>& costs) {
+  std::set<std::string> selected;
+
+  if (costs.empty()) {
+    for (const auto& d : datasets)
+      if (stableHash(d) % shard.count == shard.index - 1)
+	selected.insert(d);
+    return selected;
+  }
+
+  double mean = 0;
+  for (const auto& c : costs) mean += c.second;
+  mean /= costs.size();
+
+  std::vector<std::pair<double, std::string>> order;
+  for (const auto& d : datasets) {
+    auto it = costs.find(d);
+    order.push_back(std::make_pair(it == costs.end() ? mean : it->second, d));
+  }
+
+  /* The order must not depend on the order of the reference file */
+  std::sort(order.begin(), order.end(),
+	    [](const std::pair<double, std::string>& l,
+	       const std::pair<double, std::string>& r) {
+	      if (l.first != r.first) return l.first > r.first;
+	      return l.second < r.second;
+	    });
+
+  std::vector<double> load(shard.count, 0);
+  for (const auto& o : order) {
+    unsigned int s = std::min_element(load.begin(), load.end()) - load.begin();
+    load[s] += o.first;
+    if (s == shard.index - 1) selected.insert(o.second);
+  }
+
+  return selected;
+}
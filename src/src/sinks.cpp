@@ -0,0 +1,501 @@
+#include "sinks.hpp"
+#include "helpers.hpp"
+#include "io.hpp"
+#include "bulk.hpp"
+#include "scheduler.hpp"
+
+#include <pqxx/pqxx>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+
+#include <sys/stat.h>
+
+SmidataTarget::SmidataTarget(const Options& opts, const std::string& info)
+  : bulk_(opts.get("bulk", "")), table_("smidata") {
+
+  if (bulk_ != "" && bulk_ != "load" && bulk_ != "attach")
+    throw std::runtime_error("--bulk should be load or attach");
+
+  std::string payload = opts.get("payload", "inline");
+  if (payload != "inline" && payload != "blob")
+    throw std::runtime_error("--payload should be inline or blob");
+  blobs_ = (payload == "blob");
+
+  pqxx::connection conn;
+  pqxx::work w_dataset(conn);
+
+  w_dataset.conn().prepare("insert_dataset", "insert into smidata_desc (id, description, created_at) "
+			   "values ($1, $2, now())");
+
+  if (opts.has("dataset-id")) {
+    dataid_ = std::stol(opts.get("dataset-id"));
+  } else {
+    dataid_ = w_dataset.exec("select nextval('smidata_desc_id_seq')")[0][0]
+      .as<long int>();
+
+    w_dataset.prepared("insert_dataset")
+      (dataid_)
+      (info).exec();
+  }
+
+  if (bulk_ != "") {
+    createSmidataPartition(w_dataset, dataid_);
+    table_ = smidataPartition(dataid_);
+  }
+
+  w_dataset.commit();
+}
+
+long int SmidataTarget::id() const {
+  return dataid_;
+}
+
+const std::string& SmidataTarget::table() const {
+  return table_;
+}
+
+std::string SmidataTarget::payloadColumns() const {
+  return blobs_ ? "data_int_hash, data_img_hash" : "data_int, data_img";
+}
+
+std::string SmidataTarget::encodePayload(BlobStore& blobs, const std::vector<float>& data) const {
+  std::string encoded = base64_encode(write_binary(data.data(), data.size()));
+  return blobs_ ? blobs.store(encoded) : encoded;
+}
+
+void SmidataTarget::finish() {
+  if (bulk_ != "attach") return;
+
+  pqxx::connection conn;
+  pqxx::work w_attach(conn);
+  attachSmidataPartition(w_attach, dataid_);
+  w_attach.commit();
+}
+
+
+class ClassificationWriter : public DatasetWriter {
+  ClassificationSink& sink_;
+  const DatasetContext& d_;
+  pqxx::connection conn_;
+  pqxx::work w_;
+  BlobStore blobs_;
+
+public:
+  ClassificationWriter(ClassificationSink& sink, const DatasetContext& d)
+    : sink_(sink), d_(d), w_(conn_), blobs_(w_) {
+    w_.conn().prepare("insert_record",
+		      "insert into " + sink.target().table() + " (dataset_id, source_data_set, "
+		      "source_track_id, track_start, track_end, category, levels_order, track_size, "
+		      "frame_dim_int, frame_dim_img, scores, levels, " + sink.target().payloadColumns() +
+		      ", lda_filter, levels_old, levels_new, scores_old, scores_new) "
+		      "values($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15, $16, $17,"
+		      "$18, $19);");
+  }
+
+  TrackStatus write(TrackData& t) {
+    MSMMDataModel::Track track = t.track();
+    MSMMDataModel::TrackId tid = t.tid();
+    unsigned int category = t.category();
+
+    /* Calculate scores and levels */
+    MSMMDataModel::LevelOptions lo;
+    lo.overwrite = true;
+    lo.level_version = MSMMDataModel::LevelOptions::StepProb;
+    track.set_level_options(lo);
+    track.calc_scores(d_.cc, d_.frames, d_.project.get_options().spot_fwhm);
+
+    std::string track_case;
+    TrackStatus status = sink_.filters().check(t.context(track, &track_case),
+					       FilterChain::AfterLevels);
+
+    /* The gdr filter already found the case of the tracks it passed */
+    if (status == TrackImported && track_case.empty())
+      status = getTrackCase(track, d_.project, d_.gdrs, track_case);
+
+    if (status != TrackImported) {
+      if (category) std::cout << "track " << tid << " " << trackStatusName(status) << std::endl;
+      return status;
+    }
+
+    try {
+      float filter = 0;
+      for (const auto& p : sink_.plane()) filter += p.second * track.get_score(p.first);
+
+      std::string scores = getScores(track, exported_scores, MSMMDataModel::LevelOptions::Std, d_.project);
+      std::string scores_old = getScores(track, exported_scores, MSMMDataModel::LevelOptions::StepProb, d_.project);
+      std::string scores_new = getScores(track, exported_scores, MSMMDataModel::LevelOptions::NNet, d_.project);
+
+      std::string levels = getLevels(track, MSMMDataModel::LevelOptions::Std, d_.project);
+      std::string levels_old = getLevels(track, MSMMDataModel::LevelOptions::StepProb, d_.project);
+      std::string levels_new = getLevels(track, MSMMDataModel::LevelOptions::NNet, d_.project);
+
+      /* Check for consistency and add to the data files */
+      if (!t.complete()) return TrackSizeMismatch;
+
+      w_.prepared("insert_record")
+	(sink_.target().id())
+	(d_.source_data_set)
+	(tid)
+	(t.extrapolated().first_non_interpolated_frameid())
+	(t.extrapolated().last_non_interpolated_frameid())
+	(category)
+	(track_case)
+	(t.trackSize())
+	(TrackData::IntDim)
+	(TrackData::ImgDim)
+	(scores)
+	(levels)
+	(sink_.target().encodePayload(blobs_, t.dataInt()))
+	(sink_.target().encodePayload(blobs_, t.dataImg()))
+	(filter)
+	(levels_old)
+	(levels_new)
+	(scores_old)
+	(scores_new).exec();
+
+      std::cout << "record " << tid << " inserted " << std::endl;
+      return TrackImported;
+
+    } catch(const pqxx::failure&) {
+      /* The transaction is broken, the remaining tracks would fail too */
+      throw;
+    } catch(const std::exception& e) {
+      std::cerr << "track " << tid << " failed: " << e.what() << std::endl;
+      return TrackFailed;
+    } catch(...) {
+      return TrackFailed;
+    }
+  }
+
+  void close() {
+    w_.commit();
+    std::cout << "records commited. Starting new dataset ..." << std::endl;
+  }
+};
+
+ClassificationSink::ClassificationSink(const Options& opts, const std::string& info,
+				       const std::string& filters)
+  : TrackSink(filters), target_(opts, info), plane_(MSMMDataModel::GetCombiScore1()) {}
+
+std::string ClassificationSink::name() const {
+  return "classification";
+}
+
+std::unique_ptr<DatasetWriter> ClassificationSink::open(const DatasetContext& d) {
+  return std::unique_ptr<DatasetWriter>(new ClassificationWriter(*this, d));
+}
+
+void ClassificationSink::finish() {
+  target_.finish();
+}
+
+const SmidataTarget& ClassificationSink::target() const {
+  return target_;
+}
+
+const MSMMDataModel::CombiScore& ClassificationSink::plane() const {
+  return plane_;
+}
+
+
+class LevelDetectionWriter : public DatasetWriter {
+  LevelDetectionSink& sink_;
+  const DatasetContext& d_;
+  pqxx::connection conn_;
+  pqxx::work w_;
+  BlobStore blobs_;
+
+public:
+  LevelDetectionWriter(LevelDetectionSink& sink, const DatasetContext& d)
+    : sink_(sink), d_(d), w_(conn_), blobs_(w_) {
+    w_.conn().prepare("insert_record",
+		      "insert into " + sink.target().table() + " (dataset_id, source_data_set, "
+		      "source_track_id, track_start, track_end, category, track_size, frame_dim_int, "
+		      "frame_dim_img, levels, levels_old, levels_new, " + sink.target().payloadColumns() + ")"
+		      "values($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14)");
+  }
+
+  TrackStatus write(TrackData& t) {
+    MSMMDataModel::TrackId tid = t.tid();
+
+    try {
+      /* Extract Levels of the extrapolated track */
+      MSMMDataModel::Track track = t.extrapolated();
+      MSMMDataModel::LevelOptions lo;
+      lo.overwrite = true;
+
+      lo.level_version = MSMMDataModel::LevelOptions::NNet;
+      track.set_level_options(lo);
+      track.calc_scores(d_.cc, d_.frames, d_.project.get_options().spot_fwhm);
+      std::string levels_new = serializeLevels(track);
+
+      lo.level_version = MSMMDataModel::LevelOptions::StepProb;
+      track.set_level_options(lo);
+      track.calc_scores(d_.cc, d_.frames, d_.project.get_options().spot_fwhm);
+      std::string levels_old = serializeLevels(track);
+
+      lo.level_version = MSMMDataModel::LevelOptions::Std;
+      track.set_level_options(lo);
+      track.calc_scores(d_.cc, d_.frames, d_.project.get_options().spot_fwhm);
+      std::string levels = serializeLevels(track);
+
+      TrackStatus status = sink_.filters().check(t.context(track), FilterChain::AfterLevels);
+      if (status != TrackImported) return status;
+
+      /* Check for consistency and add to the data files */
+      if (!t.complete()) return TrackSizeMismatch;
+
+      w_.prepared("insert_record")
+	(sink_.target().id())
+	(d_.source_data_set)
+	(tid)
+	(track.first_non_interpolated_frameid())
+	(track.last_non_interpolated_frameid())
+	(t.category())
+	(t.trackSize())
+	(TrackData::IntDim)
+	(TrackData::ImgDim)
+	(levels)
+	(levels_old)
+	(levels_new)
+	(sink_.target().encodePayload(blobs_, t.dataInt()))
+	(sink_.target().encodePayload(blobs_, t.dataImg())).exec();
+
+      return TrackImported;
+
+    } catch(const pqxx::failure&) {
+      /* The transaction is broken, the remaining tracks would fail too */
+      throw;
+    } catch(const std::exception& e) {
+      std::cerr << "track " << tid << " failed: " << e.what() << std::endl;
+      return TrackFailed;
+    } catch(...) {
+      return TrackFailed;
+    }
+  }
+
+  void close() {
+    w_.commit();
+  }
+};
+
+LevelDetectionSink::LevelDetectionSink(const Options& opts, const std::string& info,
+				       const std::string& filters)
+  : TrackSink(filters), target_(opts, info) {}
+
+std::string LevelDetectionSink::name() const {
+  return "level-detection";
+}
+
+std::unique_ptr<DatasetWriter> LevelDetectionSink::open(const DatasetContext& d) {
+  return std::unique_ptr<DatasetWriter>(new LevelDetectionWriter(*this, d));
+}
+
+void LevelDetectionSink::finish() {
+  target_.finish();
+}
+
+const SmidataTarget& LevelDetectionSink::target() const {
+  return target_;
+}
+
+
+class CsvWriter : public DatasetWriter {
+  std::string prefix_;
+
+public:
+  CsvWriter(const std::string& prefix) : prefix_(prefix) {}
+
+  TrackStatus write(TrackData& t) {
+    std::stringstream ss_intensity;
+    ss_intensity << prefix_ << "track_" << t.tid() << "-intensity.csv";
+    std::ofstream out_intensity(ss_intensity.str());
+
+    std::stringstream ss_image;
+    ss_image << prefix_ << "track_" << t.tid() << "-image.csv";
+    std::ofstream out_image(ss_image.str());
+
+    out_intensity << "frame id,"
+		  << "intensity, "
+		  << "intensity error, "
+		  << "pos_x, pos_y, "
+		  << "background intensity, "
+		  << "interpolated" << std::endl;
+
+    try {
+      const std::vector<float>& data_int = t.dataInt();
+      const std::vector<float>& data_img = t.dataImg();
+
+      for (unsigned int f = 0; f < t.frames(); f++) {
+	const float* v = &data_int[f * TrackData::IntDim];
+	out_intensity << (MSMMDataModel::FrameId)v[0] << ","
+		      << v[1] << ","
+		      << v[2] << ","
+		      << v[3] << ","
+		      << v[4] << ","
+		      << v[5] << ","
+		      << (int)v[6] << std::endl;
+
+	const float* p = &data_img[f * TrackData::ImgDim];
+	for (unsigned int i = 0; i < TrackData::ImgDim; i++) {
+	  out_image << p[i];
+	  if (i != TrackData::ImgDim - 1)
+	    out_image << ",";
+	}
+	out_image << std::endl;
+      }
+
+      return TrackImported;
+
+    } catch(const std::exception& e) {
+      std::cerr << "track " << t.tid() << " failed: " << e.what() << std::endl;
+      return TrackFailed;
+    } catch(...) {
+      return TrackFailed;
+    }
+  }
+};
+
+CsvSink::CsvSink(const std::string& directory, bool per_dataset,
+		 const std::string& filters)
+  : TrackSink(filters), directory_(directory), per_dataset_(per_dataset) {}
+
+std::string CsvSink::name() const {
+  return "csv";
+}
+
+std::unique_ptr<DatasetWriter> CsvSink::open(const DatasetContext& d) {
+  std::string directory = directory_;
+
+  /* The path of the data set is repeated below the directory, so data sets
+   * of the same name in different projects do not share one. Parent
+   * references are kept inside the directory.
+   */
+  if (per_dataset_) {
+    std::stringstream path_ss(d.source_data_set);
+    std::string part;
+
+    while (std::getline(path_ss, part, '/')) {
+      if (part.empty() || part == ".") continue;
+      if (part == "..") part = "_";
+
+      directory += "/" + part;
+      if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST)
+	throw std::runtime_error("Cannot create directory " + directory);
+    }
+  }
+
+  return std::unique_ptr<DatasetWriter>(new CsvWriter(directory + "/"));
+}
+
+
+/* Writes a frames x dim array of floats into a new data set of the group */
+static void writeArray(hid_t group, const char* name,
+		       const std::vector<float>& data, unsigned int dim) {
+  hsize_t dims[2] = {data.size() / dim, dim};
+  hid_t space = H5Screate_simple(2, dims, NULL);
+  hid_t set = H5Dcreate2(group, name, H5T_NATIVE_FLOAT, space,
+			 H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  herr_t err = set < 0 ? -1 :
+    H5Dwrite(set, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data());
+
+  if (set >= 0) H5Dclose(set);
+  H5Sclose(space);
+  if (err < 0) throw std::runtime_error(std::string("Cannot write ") + name);
+}
+
+static void writeAttribute(hid_t group, const char* name, const std::string& value) {
+  hid_t type = H5Tcopy(H5T_C_S1);
+  H5Tset_size(type, value.size() + 1);
+  hid_t space = H5Screate(H5S_SCALAR);
+  hid_t attr = H5Acreate2(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+  herr_t err = attr < 0 ? -1 : H5Awrite(attr, type, value.c_str());
+
+  if (attr >= 0) H5Aclose(attr);
+  H5Sclose(space);
+  H5Tclose(type);
+  if (err < 0) throw std::runtime_error(std::string("Cannot write ") + name);
+}
+
+static void writeAttribute(hid_t group, const char* name, unsigned int value) {
+  hid_t space = H5Screate(H5S_SCALAR);
+  hid_t attr = H5Acreate2(group, name, H5T_NATIVE_UINT, space, H5P_DEFAULT, H5P_DEFAULT);
+  herr_t err = attr < 0 ? -1 : H5Awrite(attr, H5T_NATIVE_UINT, &value);
+
+  if (attr >= 0) H5Aclose(attr);
+  H5Sclose(space);
+  if (err < 0) throw std::runtime_error(std::string("Cannot write ") + name);
+}
+
+class Hdf5Writer : public DatasetWriter {
+  Hdf5Sink& sink_;
+
+public:
+  Hdf5Writer(Hdf5Sink& sink) : sink_(sink) {}
+
+  TrackStatus write(TrackData& t) {
+    try {
+      /* Extrapolate before taking the lock, the other threads keep going */
+      t.dataInt();
+
+      std::lock_guard<std::mutex> lock(projectLoadLock());
+      sink_.write(t);
+      return TrackImported;
+
+    } catch(const std::exception& e) {
+      std::cerr << "track " << t.tid() << " failed: " << e.what() << std::endl;
+      return TrackFailed;
+    } catch(...) {
+      return TrackFailed;
+    }
+  }
+};
+
+Hdf5Sink::Hdf5Sink(const std::string& path, const std::string& filters)
+  : TrackSink(filters), groups_(0) {
+  std::lock_guard<std::mutex> lock(projectLoadLock());
+  file_ = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (file_ < 0) throw std::runtime_error("Cannot create " + path);
+}
+
+Hdf5Sink::~Hdf5Sink() {
+  finish();
+}
+
+std::string Hdf5Sink::name() const {
+  return "hdf5";
+}
+
+std::unique_ptr<DatasetWriter> Hdf5Sink::open(const DatasetContext& d) {
+  return std::unique_ptr<DatasetWriter>(new Hdf5Writer(*this));
+}
+
+void Hdf5Sink::finish() {
+  if (file_ < 0) return;
+
+  std::lock_guard<std::mutex> lock(projectLoadLock());
+  H5Fclose(file_);
+  file_ = -1;
+}
+
+void Hdf5Sink::write(TrackData& t) {
+  std::string name = "track_" + std::to_string(groups_++);
+  hid_t group = H5Gcreate2(file_, name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (group < 0) throw std::runtime_error("Cannot create group " + name);
+
+  try {
+    writeAttribute(group, "source_data_set", t.dataset().source_data_set);
+    writeAttribute(group, "source_track_id", t.tid());
+    writeAttribute(group, "category", t.category());
+    writeArray(group, "data_int", t.dataInt(), TrackData::IntDim);
+    writeArray(group, "data_img", t.dataImg(), TrackData::ImgDim);
+  } catch (...) {
+    H5Gclose(group);
+    throw;
+  }
+
+  H5Gclose(group);
+}
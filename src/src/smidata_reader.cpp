@@ -0,0 +1,189 @@
+#include "smidata_reader.hpp"
+#include "io.hpp"
+
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+Levels parseLevels(const std::string& s) {
+  Levels levels;
+  int depth = 0;
+
+  for (std::size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '}') {
+      depth--;
+      continue;
+    }
+    if (s[i] != '{') continue;
+
+    depth++;
+    if (depth == 2) levels.push_back(std::vector<std::pair<int, int>>());
+    if (depth != 3) continue;
+
+    char* end;
+    int low = std::strtol(s.c_str() + i + 1, &end, 10);
+    if (*end != ',') throw std::runtime_error("Bad levels " + s);
+    int high = std::strtol(end + 1, &end, 10);
+    if (*end != '}') throw std::runtime_error("Bad levels " + s);
+
+    levels.back().push_back(std::make_pair(low, high));
+    i = end - s.c_str() - 1;
+  }
+
+  if (depth != 0) throw std::runtime_error("Bad levels " + s);
+  return levels;
+}
+
+Scores parseScores(const std::string& s) {
+  Scores scores;
+  std::size_t pos = 0;
+
+  while ((pos = s.find('"', pos)) != std::string::npos) {
+    std::size_t end = s.find('"', pos + 1);
+    std::size_t arrow = s.find("->", end);
+    if (end == std::string::npos || arrow == std::string::npos)
+      throw std::runtime_error("Bad scores " + s);
+
+    char* stop;
+    scores[s.substr(pos + 1, end - pos - 1)] = std::strtof(s.c_str() + arrow + 2, &stop);
+    pos = stop - s.c_str();
+  }
+
+  return scores;
+}
+
+
+SmiDataReader::SmiDataReader(pqxx::work& work, long int dataset_id)
+  : work_(work), dataset_id_(dataset_id) {
+
+  work_.conn().prepare("select_smidata_shape",
+		       "select count(*), coalesce(max(track_size), 0), "
+		       "coalesce(max(frame_dim_int), 0), coalesce(max(frame_dim_img), 0) "
+		       "from smidata where dataset_id = $1");
+
+  pqxx::result shape = work_.prepared("select_smidata_shape")(dataset_id_).exec();
+  size_ = shape[0][0].as<unsigned int>();
+  track_size_ = shape[0][1].as<unsigned int>();
+  int_dim_ = shape[0][2].as<unsigned int>();
+  img_dim_ = shape[0][3].as<unsigned int>();
+}
+
+unsigned int SmiDataReader::size() const {
+  return size_;
+}
+
+unsigned int SmiDataReader::trackSize() const {
+  return track_size_;
+}
+
+unsigned int SmiDataReader::intDim() const {
+  return int_dim_;
+}
+
+unsigned int SmiDataReader::imgDim() const {
+  return img_dim_;
+}
+
+/* Decodes a base64 column into a record of track_size frames and pads the
+ * frames after the end of the track with NaN. Returns the number of frames.
+ */
+static unsigned int decodeFrames(const pqxx::field& field, float* out,
+				 unsigned int track_size, unsigned int dim) {
+  std::size_t capacity = (std::size_t)track_size * dim;
+  std::size_t bytes = base64_decode(field.c_str(), field.size(),
+				    (unsigned char*)out, capacity * sizeof(float));
+
+  if (bytes % (dim * sizeof(float)))
+    throw std::runtime_error("smidata frame data is not a whole number of frames");
+
+  std::fill(out + bytes / sizeof(float), out + capacity,
+	    std::numeric_limits<float>::quiet_NaN());
+  return bytes / (dim * sizeof(float));
+}
+
+static void readRecord(const pqxx::tuple& row, SmiRecord& r) {
+  r.source_data_set = row["source_data_set"].as<std::string>();
+  r.source_track_id = row["source_track_id"].as<unsigned int>();
+  r.track_start = row["track_start"].as<int>();
+  r.track_end = row["track_end"].as<int>();
+  r.category = row["category"].as<unsigned int>();
+
+  if (!row["levels_order"].is_null()) r.levels_order = row["levels_order"].as<std::string>();
+
+  if (!row["levels"].is_null()) r.levels = parseLevels(row["levels"].as<std::string>());
+  if (!row["levels_old"].is_null()) r.levels_old = parseLevels(row["levels_old"].as<std::string>());
+  if (!row["levels_new"].is_null()) r.levels_new = parseLevels(row["levels_new"].as<std::string>());
+
+  if (!row["scores"].is_null()) r.scores = parseScores(row["scores"].as<std::string>());
+  if (!row["scores_old"].is_null()) r.scores_old = parseScores(row["scores_old"].as<std::string>());
+  if (!row["scores_new"].is_null()) r.scores_new = parseScores(row["scores_new"].as<std::string>());
+}
+
+void SmiDataReader::read(float* data_int, float* data_img,
+			 std::vector<SmiRecord>& records,
+			 ThreadPool& pool,
+			 unsigned int batch) {
+  records.assign(size_, SmiRecord());
+
+  std::string query =
+    "select source_data_set, source_track_id, track_start, track_end, category, "
+    "levels_order, frame_dim_int, frame_dim_img, levels, levels_old, levels_new, "
+    "scores, scores_old, scores_new, ";
+
+  /* Records imported with --payload blob keep their payloads in smiblob */
+  bool blobs = !work_.exec("select to_regclass('smiblob')")[0][0].is_null();
+  if (blobs) {
+    query += "coalesce(data_int, (select data from smiblob where hash = data_int_hash)) as data_int";
+    if (data_img)
+      query += ", coalesce(data_img, (select data from smiblob where hash = data_img_hash)) as data_img";
+  } else {
+    query += "data_int";
+    if (data_img) query += ", data_img";
+  }
+
+  query += " from smidata where dataset_id = " + std::to_string(dataset_id_) +
+    " order by source_data_set, source_track_id";
+
+  pqxx::icursorstream stream(work_, query, "smidata_reader", batch);
+
+  unsigned int offset = 0;
+  pqxx::result rows;
+  try {
+    while (stream >> rows) {
+      if (offset + rows.size() > size_)
+	throw std::runtime_error("smidata rows were added while reading");
+
+      for (unsigned int i = 0; i < rows.size(); i++) {
+	unsigned int n = offset + i;
+
+	pool.submit([=, &records]() {
+	  const pqxx::tuple row = rows[i];
+	  if (row["frame_dim_int"].as<unsigned int>() != int_dim_ ||
+	      (data_img && row["frame_dim_img"].as<unsigned int>() != img_dim_))
+	    throw std::runtime_error("smidata frame dimensions differ between rows");
+
+	  SmiRecord& r = records[n];
+	  readRecord(row, r);
+
+	  r.length = decodeFrames(row["data_int"],
+				  data_int + (std::size_t)n * track_size_ * int_dim_,
+				  track_size_, int_dim_);
+	  if (data_img)
+	    decodeFrames(row["data_img"],
+			 data_img + (std::size_t)n * track_size_ * img_dim_,
+			 track_size_, img_dim_);
+	});
+      }
+      offset += rows.size();
+    }
+  } catch (...) {
+    /* The queued tasks write into the caller's arrays */
+    try { pool.wait(); } catch (...) {}
+    throw;
+  }
+
+  pool.wait();
+  if (offset != size_)
+    throw std::runtime_error("smidata rows were removed while reading");
+}
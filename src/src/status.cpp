@@ -0,0 +1,31 @@
+#include "status.hpp"
+
+const char* trackStatusName(TrackStatus status) {
+  switch (status) {
+  case TrackImported: return "imported";
+  case TrackFiltered: return "filtered";
+  case TrackTooFewLevels: return "too few levels";
+  case TrackBadStructure: return "bad structure";
+  case TrackNotInGDR: return "not in GDR";
+  case TrackSizeMismatch: return "size mismatch";
+  case TrackFailed: return "failed";
+  default: return "unknown";
+  }
+}
+
+TrackStatistics::TrackStatistics() {
+  for (unsigned int i = 0; i < TrackStatusCount; i++) counts_[i] = 0;
+}
+
+void TrackStatistics::count(TrackStatus status) {
+  counts_[status]++;
+}
+
+unsigned long TrackStatistics::operator[](TrackStatus status) const {
+  return counts_[status];
+}
+
+void TrackStatistics::report(std::ostream& out) const {
+  for (unsigned int i = 0; i < TrackStatusCount; i++)
+    out << trackStatusName((TrackStatus)i) << ": " << counts_[i] << std::endl;
+}
@@ -0,0 +1,71 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads)
+  : busy_(0), stop_(false) {
+  if (!threads) threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (unsigned int i = 0; i < threads; i++)
+    workers_.push_back(std::thread(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    stop_ = true;
+  }
+  ready_.notify_all();
+  for (auto& w : workers_) w.join();
+}
+
+unsigned int ThreadPool::size() const {
+  return workers_.size();
+}
+
+void ThreadPool::work() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      ready_.wait(l, [this]() { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      busy_++;
+    }
+
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> l(lock_);
+      if (!error_) error_ = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      busy_--;
+    }
+    idle_.notify_all();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    tasks_.push_back(std::move(task));
+  }
+  ready_.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> l(lock_);
+  idle_.wait(l, [this]() { return tasks_.empty() && !busy_; });
+
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
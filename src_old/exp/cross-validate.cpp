@@ -1,4 +1,5 @@
 #include "exp/experiment.hpp"
+#include "exp/cross_validation.hpp"
 #include "objective/ffnn_classify.hpp"
 #include "objective/hmm.hpp"
 #include "objective/common.hpp"
@@ -11,6 +12,7 @@
 #include <stdexcept>
 #include <pqxx/pqxx>
 #include <algorithm>
+#include <random>
 #include <boost/program_options.hpp>
 
 using namespace track_select;
@@ -19,7 +21,7 @@ namespace track_select {
   namespace exp {
 
     template<class HMM_type>
-    Matrix hmm_est(const data::SequenceSet& data,
+    Matrix hmm_est(const data::SequenceSetView& data,
                     const HMM_type& yes,  real prior_y,
                     const HMM_type& no, real prior_n) {
       Matrix conf = Matrix::Zero(2, 2);
@@ -80,11 +82,12 @@ namespace track_select {
              >> hidden_states_y
              >> hidden_states_n;
 
-          data::SequenceSet data_set = *(data::SequenceSet*)exp->
-            dataSet("Training Set");
+          data::SequenceSetView data_set(*(const data::SequenceSet*)exp->
+                                  dataSet("Training Set"));
+          std::mt19937 generator(std::random_device{}());
 
-          auto estimate = [=](const data::SequenceSet& train,
-                              const data::SequenceSet& test) {
+          auto estimate = [=](const data::SequenceSetView& train,
+                              const data::SequenceSetView& test) {
             real p_yes = 0;
             for (const auto& t : train) p_yes += t.category();
             p_yes /= train.size();
@@ -121,15 +124,13 @@ namespace track_select {
           try {
             while(1) {
               try {
-                mutex.lock();
-                algorithm::random_shuffle(data_set.begin(), data_set.end());
-                mutex.unlock();
-                result = optimizer::cross_validate(data_set, folds, estimate,
-                                                   data::SequenceSet::zero_class_check);
+                data_set.shuffle(generator);
+                result = crossValidate(data_set, folds, estimate,
+                                       data::SequenceSetView::zero_class_check);
                 break;
               } catch (data::ErrorNullClass e) {
                 std::cerr << "Warning: cross-validation partition for thread id "
-                          << thread_id << " data set id " << data_set.id()
+                          << thread_id << " data set id " << data_set.set().id()
                           << " has zero class. Reshuffling..."
                           << std::endl;
               }
@@ -219,12 +220,13 @@ namespace track_select {
              >> hidden_states_y
              >> hidden_states_n;
 
-          data::SequenceSet data_set = *(data::SequenceSet*)exp->
-            dataSet("Training Set");
+          data::SequenceSetView data_set(*(const data::SequenceSet*)exp->
+                                  dataSet("Training Set"));
+          std::mt19937 generator(std::random_device{}());
 
 
-          auto estimate = [=](const data::SequenceSet& train,
-                              const data::SequenceSet& test) {
+          auto estimate = [=](const data::SequenceSetView& train,
+                              const data::SequenceSetView& test) {
             real prior_y = 0;
             real prior_n = 0;
 
@@ -271,15 +273,13 @@ namespace track_select {
           try {
             while(1) {
               try {
-                mutex.lock();
-                algorithm::random_shuffle(data_set.begin(), data_set.end());
-                mutex.unlock();
-                result = optimizer::cross_validate(data_set, folds, estimate,
-                                                   data::SequenceSet::zero_class_check);
+                data_set.shuffle(generator);
+                result = crossValidate(data_set, folds, estimate,
+                                       data::SequenceSetView::zero_class_check);
                 break;
               } catch (data::ErrorNullClass e) {
                 std::cerr << "Warning: cross-validation partition for thread id "
-                          << thread_id << " data set id " << data_set.id()
+                          << thread_id << " data set id " << data_set.set().id()
                           << " has zero class. Reshuffling..."
                           << std::endl;
               }
@@ -394,12 +394,13 @@ namespace track_select {
              >> hu
              >> hs;
 
-          data::SequenceSet data_set = *(data::SequenceSet*)exp->
-            dataSet("Training Set");
+          data::SequenceSetView data_set(*(const data::SequenceSet*)exp->
+                                  dataSet("Training Set"));
+          std::mt19937 generator(std::random_device{}());
 
 
-          auto estimate = [=](const data::SequenceSet& train,
-                              const data::SequenceSet& test) {
+          auto estimate = [=](const data::SequenceSetView& train,
+                              const data::SequenceSetView& test) {
 
             objective::HMM train_obj(population, hu, hs, fitness, train);
 
@@ -440,15 +441,13 @@ namespace track_select {
           try {
             while(1) {
               try {
-                mutex.lock();
-                algorithm::random_shuffle(data_set.begin(), data_set.end());
-                mutex.unlock();
-                result = optimizer::cross_validate(data_set, folds, estimate,
-                                                   data::SequenceSet::zero_class_check);
+                data_set.shuffle(generator);
+                result = crossValidate(data_set, folds, estimate,
+                                       data::SequenceSetView::zero_class_check);
                 break;
               } catch (data::ErrorNullClass e) {
                 std::cerr << "Warning: cross-validation partition for thread id "
-                          << thread_id << " data set id " << data_set.id()
+                          << thread_id << " data set id " << data_set.set().id()
                           << " has zero class. Reshuffling..."
                           << std::endl;
               }
@@ -485,7 +484,8 @@ namespace track_select {
                            unsigned int data_set_id,
                            real init_sigma,
                            real mutate_sigma,
-                           unsigned int iterations) {
+                           unsigned int iterations,
+                           bool single_precision) {
 
       Experiment e(30);
 
@@ -512,6 +512,7 @@ namespace track_select {
 
         .addProperty("classifier", "feed forward neural network")
         .addProperty("classifier.hidden-units", hidden_units)
+        .addProperty("classifier.single-precision", single_precision)
         .addDataSet("Training Set", &train);
 
       e.run([](Experiment *exp, unsigned int thread_id, std::mutex& mutex) {
@@ -524,6 +525,7 @@ namespace track_select {
           real iterations;
           real folds;
           real hu;
+          bool single_precision;
 
 
           std::stringstream ss;
@@ -535,7 +537,8 @@ namespace track_select {
              << exp->property("optimizer.adaptive-mutation-bias")  << " "
              << exp->property("optimizer.iterations")  << " "
              << exp->property("validation.folds")  << " "
-             << exp->property("classifier.hidden-units")  << " ";
+             << exp->property("classifier.hidden-units")  << " "
+             << exp->property("classifier.single-precision")  << " ";
 
           ss >> population
              >> fitness
@@ -545,16 +548,21 @@ namespace track_select {
              >> adaptive_mutation_bias
              >> iterations
              >> folds
-             >> hu;
+             >> hu
+             >> single_precision;
 
-          data::FeatureVectorSet data_set = *(data::FeatureVectorSet*)exp->
-            dataSet("Training Set");
+          data::FeatureVectorSetView data_set(*(const data::FeatureVectorSet*)exp->
+                                  dataSet("Training Set"));
+          std::mt19937 generator(std::random_device{}());
 
 
-          auto estimate = [=](const data::FeatureVectorSet& train,
-                              const data::FeatureVectorSet& test) {
+          auto estimate = [=](const data::FeatureVectorSetView& train,
+                              const data::FeatureVectorSetView& test) {
 
             objective::FFNNClassify train_obj(population, hu, fitness, train);
+            /* Only the training runs the network many times, the test
+             * fitness is computed once in real */
+            train_obj.setSinglePrecision(single_precision);
 
             train_obj.setProperty("initialisation sigma", initialisation_sigma);
             train_obj.setProperty("mutation sigma", mutation_sigma);
@@ -594,15 +602,13 @@ namespace track_select {
           try {
             while(1) {
               try {
-                mutex.lock();
-                algorithm::random_shuffle(data_set.begin(), data_set.end());
-                mutex.unlock();
-                result = optimizer::cross_validate(data_set, folds, estimate,
-                                                   data::FeatureVectorSet::zero_class_check);
+                data_set.shuffle(generator);
+                result = crossValidate(data_set, folds, estimate,
+                                       data::FeatureVectorSetView::zero_class_check);
                 break;
               } catch (data::ErrorNullClass e) {
                 std::cerr << "Warning: cross-validation partition for thread id "
-                          << thread_id << " data set id " << data_set.id()
+                          << thread_id << " data set id " << data_set.set().id()
                           << " has zero class. Reshuffling..."
                           << std::endl;
               }
@@ -708,12 +714,13 @@ namespace track_select {
              >> folds
              >> hu;
 
-          data::FeatureVectorSet data_set = *(data::FeatureVectorSet*)exp->
-            dataSet("Training Set");
+          data::FeatureVectorSetView data_set(*(const data::FeatureVectorSet*)exp->
+                                  dataSet("Training Set"));
+          std::mt19937 generator(std::random_device{}());
 
 
-          auto estimate = [=](const data::FeatureVectorSet& train,
-                              const data::FeatureVectorSet& test) {
+          auto estimate = [=](const data::FeatureVectorSetView& train,
+                              const data::FeatureVectorSetView& test) {
 
             objective::FFNNClassify train_obj(population, hu, fitness, train);
 
@@ -756,16 +763,14 @@ namespace track_select {
           try {
             while(1) {
               try {
-                mutex.lock();
-                algorithm::random_shuffle(data_set.begin(), data_set.end());
-                mutex.unlock();
+                data_set.shuffle(generator);
 
-                result = optimizer::cross_validate(data_set, folds, estimate,
-                                                   data::FeatureVectorSet::zero_class_check);
+                result = crossValidate(data_set, folds, estimate,
+                                       data::FeatureVectorSetView::zero_class_check);
                 break;
               } catch (data::ErrorNullClass e) {
                 std::cerr << "Warning: cross-validation partition for thread id "
-                          << thread_id << " data set id " << data_set.id()
+                          << thread_id << " data set id " << data_set.set().id()
                           << " has zero class. Reshuffling..."
                           << std::endl;
               }
@@ -842,13 +847,28 @@ int main(int argc, char** argv) {
 
 
   if (type == "nn") {
+    po::options_description desc("Use Feed Forward Neural Network.");
+    desc.add_options()
+      ("single-precision", "evaluate the network in float while training. "
+       "It is faster and keeps the points in half the memory, the test "
+       "fitness is still computed in real");
+
+    po::variables_map vm;
+    po::command_line_parser parser(argc, argv);
+    parser.allow_unregistered().options(desc);
+
+    po::store(parser.run(), vm);
+    po::notify(vm);
+
+    bool single_precision = vm.count("single-precision");
+
     std::vector<unsigned int> hidden;
     for (unsigned int i = 1; i < 11; i++)
       hidden.push_back(i);
 
     for (auto& hu : hidden) {
       std::cout << "cga HU " << hu << std::endl;
-      ts::exp::cross_validate_ga(info, hu, id, 5, 10, 5000);
+      ts::exp::cross_validate_ga(info, hu, id, 5, 10, 5000, single_precision);
     }
 
 
@@ -2,6 +2,8 @@
 #define __TS_ALGORITHM_H_
 #include <track-select>
 #include <fstream>
+#include <random>
+#include <algorithm>
 
 namespace track_select {
   namespace algorithm {
@@ -139,5 +141,7 @@ namespace track_select {
 
     std::string makeUUID();
 
+  }
+}
 
 #endif
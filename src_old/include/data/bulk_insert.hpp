@@ -0,0 +1,77 @@
+#ifndef __DATA_BULK_INSERT_H_
+#define __DATA_BULK_INSERT_H_
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <pqxx/pqxx>
+
+namespace track_select {
+  namespace data {
+
+    /** \breif Inserts many rows into a table with multi-row insert
+     * statements instead of a statement per row.
+     *
+     * The values of a row are given one after the other in the order of the
+     * columns, like the arguments of a prepared statement:
+     *
+     *   BulkInsert rows(work, "experiment_result", {"k", "val"});
+     *   rows(key)(value);
+     *   rows.flush();
+     *
+     * Columns not listed take their defaults, so serial ids are assigned by
+     * the database. A statement is sent once it holds rowsPerInsert rows or
+     * about bytesPerInsert bytes of values. The rest is sent by flush(),
+     * which must be called before the transaction commits.
+     */
+    class BulkInsert {
+      pqxx::work& work_;
+      std::string head_;
+      unsigned int columns_;
+
+      unsigned int rows_per_insert_;
+      size_t bytes_per_insert_;
+
+      std::string values_;
+      unsigned int rows_;
+      unsigned int fields_;
+
+      BulkInsert& field(const std::string& sql);
+
+    public:
+      BulkInsert(pqxx::work& work,
+                 const std::string& table,
+                 const std::vector<std::string>& columns,
+                 unsigned int rows_per_insert = 1000,
+                 size_t bytes_per_insert = 16 << 20);
+
+      /** \breif Adds a value to the current row. */
+      template <class value_type>
+      BulkInsert& operator()(const value_type& value);
+
+      /** \breif Adds a null to the current row. */
+      BulkInsert& operator()();
+
+      /** \breif Adds a bytea value to the current row. */
+      BulkInsert& operator()(const pqxx::binarystring& value);
+
+      /** \breif Adds size bytes at data as a bytea value, escaped straight
+       * from the buffer. */
+      BulkInsert& bytea(const void* data, size_t size);
+
+      /** \breif Sends the rows not sent yet. */
+      void flush();
+
+      /** \return number of complete rows not sent yet */
+      unsigned int pending() const;
+    };
+
+    template <class value_type>
+    BulkInsert& BulkInsert::operator()(const value_type& value) {
+      return field(work_.quote(value));
+    }
+
+  }
+}
+
+#endif
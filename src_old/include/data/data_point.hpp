@@ -8,13 +8,16 @@
 #include <pqxx/pqxx>
 #include "data/storable.hpp"
 #include "data/foreign_key.hpp"
+#include "data/bulk_insert.hpp"
+#include "data/string_interner.hpp"
 
 namespace track_select {
   namespace data {
     class DataPoint : public Storable, public ForeignKey {
 
       bool source_data_set_set_;
-      std::string source_data_set_;
+      /* Id in StringInterner::sourceDataSets() */
+      StringInterner::id_type source_data_set_;
 
       bool source_track_id_set_;
       unsigned int source_track_id_;
@@ -29,7 +32,9 @@ namespace track_select {
       unsigned int dim_;
     protected:
       virtual unsigned int size() const = 0;
-      virtual pqxx::binarystring data() const = 0;
+      /** @breif The size() * dim() values of the point, frame after frame,
+       *  as they are stored in the data column. */
+      virtual const real* values() const = 0;
       DataPoint(const pqxx::tuple& t);
     public:
       DataPoint();
@@ -42,9 +47,15 @@ namespace track_select {
       virtual bool operator==(const DataPoint&) const;
 
       virtual bool sourceDataSetSet() const;
-      virtual std::string sourceDataSet() const;
+      virtual const std::string& sourceDataSet() const;
       virtual void setSourceDataSet(const std::string&);
 
+      /** @breif The source data set as its id in
+       *  StringInterner::sourceDataSets(). Points of the same source have
+       *  the same id, so they are compared and hashed by it. */
+      virtual StringInterner::id_type sourceDataSetId() const;
+      virtual void setSourceDataSetId(StringInterner::id_type id);
+
       virtual bool sourceTrackIdSet() const;
       virtual unsigned int sourceTrackId() const;
       virtual void setSourceTrackId(unsigned int);
@@ -62,6 +73,16 @@ namespace track_select {
       virtual void setDim(unsigned int);
 
       virtual database_id store(pqxx::work& w) const;
+
+      /** @breif The columns of sequence written by storeRow */
+      static const std::vector<std::string>& storeColumns();
+
+      /** @breif Adds the point to a bulk insert into sequence over
+       *  storeColumns(), in the set with id set_id. The id is assigned by the
+       *  database. The values are written as data_type_size bytes each,
+       *  sizeof(real) or sizeof(float). */
+      virtual void storeRow(BulkInsert& rows, database_id set_id,
+                            unsigned int data_type_size = sizeof(real)) const;
     };
 
   }
@@ -2,11 +2,16 @@
 #define __DATA_DATA_SET_H_
 #include "data/storable.hpp"
 #include<mutex>
+#include<memory>
 
 namespace track_select {
   namespace data {
     class ErrorNullClass {};
 
+    template <class data_point> class DataSetStream;
+    template <class data_point> class DataSetBuilder;
+    class DataSetCache;
+
     template <class data_point>
     class DataSet : public Storable {
     public:
@@ -19,7 +24,12 @@ namespace track_select {
 
 
     private:
-      DataSet<data_point>& addDataPointWithId(const data_point& point);
+      /* Moves the point in, which spares Sequence the copy of its frames */
+      DataSet<data_point>& addDataPointWithId(data_point&& point);
+
+      /** @breif Decodes sequence records, in parallel, and adds them in
+       *  order keeping their ids. */
+      void addRecords(const pqxx::result& records);
       std::mutex lock_;
       data_container data_points_;
 
@@ -33,6 +43,13 @@ namespace track_select {
       unsigned int dim_;
 
 
+      /** @breif Reads the set without its points
+       *  @param stamp if given, receives the created_at of the set */
+      static DataSet<data_point> readHeader(database_id id, pqxx::work& work,
+                                            std::string* stamp = 0);
+      friend class DataSetStream<data_point>;
+      friend class DataSetCache;
+
       void setInfoUnsafe(const std::string& info);
       void setFrameInfoUnsafe(const std::vector<std::string>& frame_info);
       void setDimUnsafe(unsigned int dim);
@@ -128,18 +145,90 @@ namespace track_select {
 
       iterator erase(iterator el);
       iterator erase(iterator begin, iterator end);
+
+      /** @breif Moves the points of the builders to the end of the set, in
+       *  the order of the builders, taking the lock once. The builders are
+       *  left empty. */
+      DataSet<data_point>& merge(std::vector<DataSetBuilder<data_point>>& builders);
+      DataSet<data_point>& merge(DataSetBuilder<data_point>& builder);
       /** @} */
 
       /** @name Storage Access */
       /** @{ */
       database_id store(pqxx::work& work) const;
-      static DataSet<data_point> read(database_id id, pqxx::work& work);
+
+      /** @breif Stores the set with the values of the points written as
+       *  data_type_size bytes each. sizeof(float) halves the size of the
+       *  stored data. */
+      database_id store(pqxx::work& work, unsigned int data_type_size) const;
+
+      /** @breif Stores the set without its points.
+       *  @return the id of the new set */
+      database_id storeHeader(pqxx::work& work) const;
+
+      /** @breif Stores the points into the stored set with id set_id. Sets
+       *  too large for memory are written a batch at a time this way. */
+      void storePoints(database_id set_id, pqxx::work& work,
+                       unsigned int data_type_size = sizeof(real)) const;
+      /** @breif Reads the set and its points through one cursor, batch_size
+       *  records at a time. The points are in the order of their ids.
+       *  @note With TRACK_SELECT_CACHE set the points are read from the
+       *  local copy of the set if there is one, see DataSetCache. */
+      static DataSet<data_point> read(database_id id, pqxx::work& work,
+                                      unsigned int batch_size = 4096);
+
+      /** @breif Opens a cursor over the set for reading it batch_size points
+       *  at a time. The cursor lives as long as the transaction. */
+      static DataSetStream<data_point> stream(database_id id, pqxx::work& work,
+                                              unsigned int batch_size = 4096);
       /** @} */
 
       static void zero_class_check(const DataSet<data_point>& v_set);
 
 
     };
+
+    /** @breif Points collected by one thread for a DataSet. Adding to a
+     *  builder takes no lock; each thread fills its own and the builders are
+     *  merged into the set once the threads are done.
+     */
+    template <class data_point>
+    class DataSetBuilder {
+      std::vector<data_point> points_;
+      bool dim_set_;
+      unsigned int dim_;
+
+      friend class DataSet<data_point>;
+    public:
+      DataSetBuilder();
+
+      /** @breif Adds a point. The points must have the same dimensionality.
+       *  @note Not thread safe. */
+      DataSetBuilder<data_point>& operator<<(const data_point& point);
+
+      void reserve(unsigned int size);
+      unsigned int size() const;
+    };
+
+    /** @breif The points of a stored set read batch by batch for a single
+     *  pass over sets larger than memory.
+     */
+    template <class data_point>
+    class DataSetStream {
+      DataSet<data_point> header_;
+      std::shared_ptr<pqxx::icursorstream> records_;
+
+    public:
+      DataSetStream(database_id id, pqxx::work& work, unsigned int batch_size);
+
+      /** @breif The set with its attributes but no points. */
+      const DataSet<data_point>& header() const;
+
+      /** @breif Replaces the points of batch by the next points of the set
+       *  and gives it the attributes of the set.
+       *  @return false once all points are read */
+      bool next(DataSet<data_point>& batch);
+    };
   }
 }
 
@@ -0,0 +1,76 @@
+#ifndef __DATA_DATA_SET_CACHE_H_
+#define __DATA_DATA_SET_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "data/data_set.hpp"
+
+namespace track_select {
+  namespace data {
+
+    class ErrorDataSetCache : public std::runtime_error {
+    public:
+      explicit ErrorDataSetCache(const std::string& str);
+    };
+
+    /** @breif Local copies of stored data sets, one file per set id.
+     *
+     *  Stored sets do not change once written, so a set read from the
+     *  database is saved to <directory>/data-set-<id>.cache and later reads
+     *  memory map the file instead of fetching the points. Each file holds a
+     *  header, the frame offsets of the points, their ids and attributes as
+     *  columns, all frames in one block and the strings of the set.
+     *
+     *  The file also keeps the created_at stamp of the set, so a set
+     *  recreated under the same id in a rebuilt database is read again, and
+     *  the type of its points, so a set cached as sequences is not read as
+     *  feature vectors.
+     *
+     *  DataSet::read uses the cache named by the TRACK_SELECT_CACHE
+     *  environment variable if it is set.
+     */
+    class DataSetCache {
+      std::string directory_;
+
+    public:
+      static const unsigned int Version;
+
+      DataSetCache(const std::string& directory);
+
+      /** @return the cache in TRACK_SELECT_CACHE or null if it is not set */
+      static std::unique_ptr<DataSetCache> fromEnvironment();
+
+      const std::string& directory() const;
+      std::string path(database_id id) const;
+
+      /** @breif Reads the cached set with the given stamp into set, which
+       *  has the header of the set and no points.
+       *  @return false if the set is not cached or was cached with another
+       *  stamp, version, real type or point type
+       *  @throw ErrorDataSetCache if the file is damaged */
+      template <class data_point>
+      bool load(database_id id, const std::string& stamp,
+                DataSet<data_point>& set) const;
+
+      /** @breif Writes the set, which must have an id. The file is written
+       *  aside and renamed, so readers never see a partial file. */
+      template <class data_point>
+      void save(const DataSet<data_point>& set, const std::string& stamp) const;
+
+      /** @breif Removes the file of the set if there is one */
+      void invalidate(database_id id) const;
+
+      /** @breif Removes the files of all sets */
+      void purge() const;
+
+      /** @return the ids of the cached sets */
+      std::vector<database_id> entries() const;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef __DATA_DATA_SET_JOIN_H_
+#define __DATA_DATA_SET_JOIN_H_
+
+#include "data/data_set_view.hpp"
+#include "data/string_interner.hpp"
+
+#include <unordered_map>
+#include <utility>
+
+namespace track_select {
+  namespace data {
+
+    /** @breif The attributes two points are matched on: the source data set,
+     *  the source track id and, if asked for, the source range. */
+    struct JoinKey {
+      StringInterner::id_type source_data_set;
+      unsigned int source_track_id;
+      real range_low;
+      real range_high;
+
+      bool operator==(const JoinKey& obj) const;
+    };
+
+    struct JoinKeyHash {
+      size_t operator()(const JoinKey& key) const;
+    };
+
+    /** @breif A hash index of the points of a view by JoinKey, to match
+     *  points of other sets with them.
+     *
+     *  The index is built once and can be probed with any number of views,
+     *  for example each batch of a DataSetStream, from several threads.
+     *  Points without a source data set or track id, or without a source
+     *  range when ranges are matched, are not indexed and never match.
+     */
+    template <class data_point>
+    class JoinIndex {
+      DataSetView<data_point> points_;
+      bool match_range_;
+
+      /* Position in points_ of the first point with the key. The other
+       * points with the key follow through next_, in the order of the view */
+      std::unordered_map<JoinKey, unsigned int, JoinKeyHash> first_;
+      std::vector<unsigned int> next_;
+
+    public:
+      static const unsigned int NoMatch;
+
+      JoinIndex(const DataSetView<data_point>& points, bool match_range = false);
+
+      /** @return whether the key of the point was taken, false if the point
+       *  misses one of the attributes */
+      static bool key(const DataPoint& point, bool match_range, JoinKey& key);
+
+      const DataSetView<data_point>& points() const;
+      bool matchRange() const;
+
+      /** @breif Inner join of probe with the indexed points. The probe is
+       *  searched in parallel.
+       *  @return two views of the same size, the i-th point of the first
+       *  matching the i-th point of the second. The pairs are in the order
+       *  of probe and, for each probe point, in the order of the index.
+       *  No point is copied. */
+      template <class probe_point>
+      std::pair<DataSetView<probe_point>, DataSetView<data_point>>
+      join(const DataSetView<probe_point>& probe) const;
+    };
+
+    /** @breif Inner join of left and right on the source data set, track id
+     *  and, with match_range, range. The hash index is built over right.
+     *  @see JoinIndex::join */
+    template <class left_point, class right_point>
+    std::pair<DataSetView<left_point>, DataSetView<right_point>>
+    join(const DataSetView<left_point>& left,
+         const DataSetView<right_point>& right,
+         bool match_range = false) {
+      return JoinIndex<right_point>(right, match_range).join(left);
+    }
+
+  }
+}
+
+#endif
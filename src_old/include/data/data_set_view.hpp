@@ -0,0 +1,136 @@
+#ifndef __DATA_DATA_SET_VIEW_H_
+#define __DATA_DATA_SET_VIEW_H_
+#include "data/data_set.hpp"
+#include "data/sequence.hpp"
+#include "data/feature_vector.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace track_select {
+  namespace data {
+
+    /** @breif An ordered selection of the points of a DataSet.
+     *
+     *  The points are not copied. A view holds the set, shared and read only,
+     *  and the indexes of the points it selects in the order it presents
+     *  them. Shuffling a view or taking its folds or classes only builds new
+     *  indexes, so any number of threads can shuffle and partition one loaded
+     *  set each in its own order.
+     */
+    template <class data_point>
+    class DataSetView {
+    public:
+      typedef std::vector<unsigned int> index_container;
+
+      /** @breif Random access iterator over the selected points */
+      class const_iterator
+        : public std::iterator<std::random_access_iterator_tag,
+                               const data_point> {
+        typename DataSet<data_point>::const_iterator points_;
+        index_container::const_iterator index_;
+      public:
+        typedef std::ptrdiff_t difference_type;
+
+        const_iterator() {}
+        const_iterator(typename DataSet<data_point>::const_iterator points,
+                       index_container::const_iterator index)
+          : points_(points), index_(index) {}
+
+        const data_point& operator*() const { return points_[*index_]; }
+        const data_point* operator->() const { return &points_[*index_]; }
+        const data_point& operator[](difference_type n) const {
+          return points_[index_[n]];
+        }
+
+        const_iterator& operator++() { ++index_; return *this; }
+        const_iterator& operator--() { --index_; return *this; }
+        const_iterator operator++(int) { const_iterator r(*this); ++index_; return r; }
+        const_iterator operator--(int) { const_iterator r(*this); --index_; return r; }
+
+        const_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        const_iterator operator+(difference_type n) const {
+          return const_iterator(points_, index_ + n);
+        }
+        const_iterator operator-(difference_type n) const {
+          return const_iterator(points_, index_ - n);
+        }
+        difference_type operator-(const const_iterator& obj) const {
+          return index_ - obj.index_;
+        }
+
+        bool operator==(const const_iterator& obj) const { return index_ == obj.index_; }
+        bool operator!=(const const_iterator& obj) const { return index_ != obj.index_; }
+        bool operator<(const const_iterator& obj) const { return index_ < obj.index_; }
+        bool operator>(const const_iterator& obj) const { return index_ > obj.index_; }
+        bool operator<=(const const_iterator& obj) const { return index_ <= obj.index_; }
+        bool operator>=(const const_iterator& obj) const { return index_ >= obj.index_; }
+      };
+
+    private:
+      std::shared_ptr<const DataSet<data_point>> set_;
+      index_container index_;
+
+      DataSetView(const std::shared_ptr<const DataSet<data_point>>& set,
+                  index_container&& index);
+    public:
+      /** @breif Selects all points of the set in their order. The view shares
+       *  the ownership of the set. */
+      DataSetView(const std::shared_ptr<const DataSet<data_point>>& set);
+
+      /** @breif Selects all points of the set in their order. The set is not
+       *  owned and must outlive the view and the views taken from it. */
+      DataSetView(const DataSet<data_point>& set);
+
+      unsigned int size() const;
+      unsigned int dim() const;
+
+      const data_point& operator[](unsigned int i) const;
+      const_iterator begin() const;
+      const_iterator end() const;
+
+      /** @breif The viewed set and the indexes of the selected points */
+      const DataSet<data_point>& set() const;
+      const index_container& indexes() const;
+
+      /** @breif Permutes the selection with the given random generator.
+       *  @note Only the view is modified, the set is shared. */
+      template <class generator>
+      void shuffle(generator& g) {
+        std::shuffle(index_.begin(), index_.end(), g);
+      }
+
+      /** @breif The points at positions [begin, end) of the view */
+      DataSetView<data_point> subset(unsigned int begin, unsigned int end) const;
+
+      /** @breif The points at the given positions of the view, in the order
+       *  of positions. A position may be given more than once. */
+      DataSetView<data_point> select(const index_container& positions) const;
+
+      /** @breif The points of the category, in the order of the view */
+      DataSetView<data_point> category(unsigned short category) const;
+
+      /** @breif Partitions the view into folds consecutive parts.
+       *  @return the training part, all folds but the k-th, and the test
+       *  part, the k-th fold.
+       */
+      std::pair<DataSetView<data_point>, DataSetView<data_point>>
+      fold(unsigned int k, unsigned int folds) const;
+
+      /** @breif Copies the selected points into a new set, in the order of
+       *  the view. */
+      DataSet<data_point> copy() const;
+
+      /** @breif Throws ErrorNullClass if the view misses one of the two
+       *  classes. */
+      static void zero_class_check(const DataSetView<data_point>& view);
+    };
+
+    typedef DataSetView<Sequence> SequenceSetView;
+    typedef DataSetView<FeatureVector> FeatureVectorSetView;
+  }
+}
+
+#endif
@@ -9,14 +9,12 @@
 namespace track_select {
   namespace data {
     class FeatureVector : public Vector,  public DataPoint {
-
-      template<class data_type>
-      void load(const pqxx::tuple& data_point);
-
     protected:
       unsigned int size() const;
-      pqxx::binarystring data() const;
+      const track_select::real* values() const;
       FeatureVector(const pqxx::tuple& t);
+
+      template <class data_point> friend class DataSet;
     public:
       FeatureVector();
       FeatureVector(unsigned int dim);
@@ -35,15 +33,6 @@ namespace track_select {
       static FeatureVector read(database_id id, pqxx::work& work);
     };
 
-    template<class data_type>
-    void FeatureVector::load(const pqxx::tuple& data_point) {
-      pqxx::binarystring data(data_point["data"]);
-      const data_type * d = (const data_type*)data.data();
-      for (unsigned int i = 0; i < dim(); i++) (*this)(i) = d[i];
-
-    }
-
-
   }
 }
 
@@ -5,6 +5,9 @@
 #include "data/foreign_key.hpp"
 #include "data/data_point.hpp"
 
+#include <iterator>
+#include <new>
+
 namespace track_select {
 
   namespace data {
@@ -15,19 +18,90 @@ namespace track_select {
     class Sequence : public DataPoint {
 
     public:
-
-      typedef std::vector<Vector>::const_iterator const_iterator;
-      typedef std::vector<Vector>::iterator iterator;
+      /** \breif A frame of the sequence, a view of its column in the
+       * sequence matrix. */
+      typedef Eigen::Map<Vector> frame;
+      typedef Eigen::Map<const Vector> const_frame;
+
+      /** \breif Iterator over the frames. It dereferences to a view it keeps
+       * itself, so the reference is valid only as long as the iterator and
+       * until it moves. That makes it an input iterator for the standard
+       * algorithms, though it moves and compares in constant time like a
+       * random access one. operator[] returns the view by value.
+       */
+      template <class frame_type, class scalar_type>
+      class FrameIterator
+        : public std::iterator<std::input_iterator_tag, frame_type> {
+
+        scalar_type* data_;
+        unsigned int dim_;
+        mutable frame_type frame_;
+
+        template <class, class> friend class FrameIterator;
+      public:
+        FrameIterator(scalar_type* data, unsigned int dim)
+          : data_(data), dim_(dim), frame_(data, dim) {}
+
+        FrameIterator(const FrameIterator& obj)
+          : data_(obj.data_), dim_(obj.dim_), frame_(obj.data_, obj.dim_) {}
+
+        /** Conversion of iterator to const_iterator */
+        template <class other_frame, class other_scalar>
+        FrameIterator(const FrameIterator<other_frame, other_scalar>& obj)
+          : data_(obj.data_), dim_(obj.dim_), frame_(obj.data_, obj.dim_) {}
+
+        FrameIterator& operator=(const FrameIterator& obj) {
+          data_ = obj.data_;
+          dim_ = obj.dim_;
+          return *this;
+        }
+
+        frame_type& operator*() const {
+          new (&frame_) frame_type(data_, dim_);
+          return frame_;
+        }
+
+        frame_type* operator->() const { return &**this; }
+        frame_type operator[](long n) const {
+          return frame_type(data_ + n * (long)dim_, dim_);
+        }
+
+        FrameIterator& operator++() { data_ += dim_; return *this; }
+        FrameIterator& operator--() { data_ -= dim_; return *this; }
+        FrameIterator operator++(int) { FrameIterator r(*this); ++*this; return r; }
+        FrameIterator operator--(int) { FrameIterator r(*this); --*this; return r; }
+
+        FrameIterator& operator+=(long n) { data_ += n * dim_; return *this; }
+        FrameIterator& operator-=(long n) { data_ -= n * dim_; return *this; }
+        FrameIterator operator+(long n) const { FrameIterator r(*this); return r += n; }
+        FrameIterator operator-(long n) const { FrameIterator r(*this); return r -= n; }
+
+        long operator-(const FrameIterator& obj) const {
+          return dim_ ? (data_ - obj.data_) / (long)dim_ : 0;
+        }
+
+        bool operator==(const FrameIterator& obj) const { return data_ == obj.data_; }
+        bool operator!=(const FrameIterator& obj) const { return data_ != obj.data_; }
+        bool operator<(const FrameIterator& obj) const { return data_ < obj.data_; }
+        bool operator>(const FrameIterator& obj) const { return data_ > obj.data_; }
+        bool operator<=(const FrameIterator& obj) const { return data_ <= obj.data_; }
+        bool operator>=(const FrameIterator& obj) const { return data_ >= obj.data_; }
+      };
+
+      typedef FrameIterator<const_frame, const real> const_iterator;
+      typedef FrameIterator<frame, real> iterator;
 
     private:
-      std::vector<Vector> eigen_data_;
-
-      template<class data_type>
-      void load(const pqxx::tuple& data_point);
+      /** The frames are the first length_ columns, the rest is room to
+       * grow. */
+      Matrix frames_;
+      unsigned int length_;
 
     protected:
-      virtual pqxx::binarystring data() const;
+      virtual const real* values() const;
       Sequence(const pqxx::tuple& t);
+
+      template <class data_point> friend class DataSet;
     public:
       /** Creates empty sequence */
       Sequence();
@@ -39,6 +113,12 @@ namespace track_select {
        */
       Sequence(const Sequence& seq);
 
+      /** \usage
+       * \param seq the sequence whose frames are taken over. It is left
+       * empty.
+       */
+      Sequence(Sequence&& seq);
+
       /**\usage
        * \param track_id - the id of the track withing the data set. Track from
        * differnet data sets can have the same id.
@@ -55,6 +135,7 @@ namespace track_select {
        * references. If the object is very large this may be expenseve operation.
        */
       virtual Sequence& operator=(const Sequence& seq);
+      Sequence& operator=(Sequence&& seq);
 
       /** \breif Tests two sequences for equality.
        * \note The order of the sequences is imporant.
@@ -66,11 +147,15 @@ namespace track_select {
       /** \name Element access */
       /** @{ */
 
-      /** \return a reference to the frame at position i. If i is out of bound
-       * throws exception IndexOutOfBound()
-       * \warning This is not copy of the data, but reference.
+      /** \return a view of the frame at position i.
+       * \warning This is not copy of the data, but reference. It is valid
+       * until the next frame is added.
        */
-      virtual const Vector& operator[](unsigned int i) const;
+      virtual const_frame operator[](unsigned int i) const;
+      virtual frame operator[](unsigned int i);
+
+      /** \return the frames as the columns of a dim x size matrix. */
+      Eigen::Map<const Matrix> matrix() const;
 
       /** @} */
 
@@ -82,6 +167,15 @@ namespace track_select {
       virtual Sequence& operator<<(const Vector& frame);
       virtual unsigned int size() const;
 
+      /** \breif Replaces the frames by the columns of frames, copied as one
+       * block.
+       * \note Sets the dimensionality if it is not set. */
+      void setFrames(const Eigen::Map<const Matrix>& frames);
+
+      /** \breif Makes room for size frames without reallocation.
+       * \note The dimensionality must be set. */
+      void reserve(unsigned int size);
+
       /** \breif Read a sequence from data base */
       static Sequence read(database_id id, pqxx::work& w);
 
@@ -93,25 +187,6 @@ namespace track_select {
 
     };
 
-    template<class data_type>
-    void Sequence::load(const pqxx::tuple& data_point) {
-      unsigned int dim = data_point["frame_dim"].as<unsigned int>();
-      unsigned int size = data_point["track_length"].as<unsigned int>();
-
-      pqxx::binarystring data(data_point["data"]);
-
-      unsigned int index = 0;
-      const data_type* d = (const data_type*)data.data();
-
-      for (unsigned int s_index = 0; s_index < size; s_index++) {
-        Vector frame(dim);
-        for (unsigned int f_index = 0; f_index < dim; f_index++)
-          frame(f_index) = d[index++];
-        (*this) << frame;
-      }
-
-    }
-
     std::ostream& operator<<(std::ostream& out, const Sequence& s);
   } // data
 }  // track_select
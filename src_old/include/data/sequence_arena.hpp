@@ -0,0 +1,105 @@
+#ifndef __DATA_SEQUENCE_ARENA_H_
+#define __DATA_SEQUENCE_ARENA_H_
+
+#include "data/sequence_set.hpp"
+#include "data/data_set_view.hpp"
+
+#include <limits>
+#include <map>
+
+namespace track_select {
+  namespace data {
+
+    /** \breif A read only sequence set with all frames in one block.
+     *
+     * The frames of all sequences are the columns of a single dim x frames
+     * matrix, one sequence after the other. offsets()[i] is the first column
+     * of sequence i and offsets()[i + 1] one past its last, so a sweep over
+     * the whole set reads memory linearly. The per sequence attributes are
+     * kept in parallel columns, the source data sets as indexes into a table
+     * holding every name once.
+     */
+    class SequenceArena {
+    public:
+      /** Values of the attribute columns for attributes not set */
+      static const unsigned short NoCategory;
+      static const unsigned int NoTrackId;
+      static const unsigned int NoSourceDataSet;
+
+    private:
+      unsigned int dim_;
+      Matrix frames_;
+      std::vector<unsigned int> offsets_;
+
+      std::vector<database_id> ids_;
+      std::vector<unsigned short> categories_;
+      std::vector<unsigned int> source_track_ids_;
+      std::vector<unsigned int> source_data_sets_;
+
+      std::vector<std::string> source_data_set_names_;
+
+      unsigned int intern(const std::string& source_data_set,
+                          std::map<std::string, unsigned int>& index);
+
+      template <class sequence_iterator>
+      void pack(sequence_iterator begin, sequence_iterator end);
+    public:
+      SequenceArena();
+
+      /** \breif Packs the sequences of the set in their order. */
+      SequenceArena(const SequenceSet& set);
+
+      /** \breif Packs the sequences of the view in its order. */
+      SequenceArena(const SequenceSetView& view);
+
+      /** \breif Splices the arenas one after the other. The frame blocks are
+       * copied once and the source data set tables merged. All parts must
+       * have the same dim. */
+      SequenceArena(const std::vector<SequenceArena>& parts);
+
+      /** \breif The number of sequences */
+      unsigned int size() const;
+      unsigned int dim() const;
+
+      /** \breif The frames of all sequences as columns */
+      const Matrix& frames() const;
+
+      /** \breif size() + 1 column offsets into frames() */
+      const std::vector<unsigned int>& offsets() const;
+
+      /** \name Sequence access */
+      /** @{ */
+      unsigned int length(unsigned int i) const;
+
+      /** \return the frames of sequence i as the columns of a view */
+      Eigen::Map<const Matrix> sequence(unsigned int i) const;
+
+      Sequence::const_iterator begin(unsigned int i) const;
+      Sequence::const_iterator end(unsigned int i) const;
+
+      /** \return the database id of sequence i or 0 if it has none */
+      database_id id(unsigned int i) const;
+      unsigned short category(unsigned int i) const;
+      unsigned int sourceTrackId(unsigned int i) const;
+
+      /** \return the index of the source data set in sourceDataSets() */
+      unsigned int sourceDataSetIndex(unsigned int i) const;
+      const std::string& sourceDataSet(unsigned int i) const;
+      /** @} */
+
+      /** \name Attribute columns */
+      /** @{ */
+      const std::vector<unsigned short>& categories() const;
+      const std::vector<unsigned int>& sourceTrackIds() const;
+      const std::vector<unsigned int>& sourceDataSetIndexes() const;
+      const std::vector<std::string>& sourceDataSets() const;
+      /** @} */
+
+      /** \breif Copies sequence i out of the arena */
+      Sequence at(unsigned int i) const;
+    };
+
+  }
+}
+
+#endif
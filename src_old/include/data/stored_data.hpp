@@ -0,0 +1,81 @@
+#ifndef __DATA_STORED_DATA_H_
+#define __DATA_STORED_DATA_H_
+
+#include <track-select>
+#include <pqxx/pqxx>
+
+namespace track_select {
+  namespace data {
+
+    /** \breif The data column of a sequence record as it was fetched.
+     *
+     * The values are frame_dim x track_length, frame after frame, of
+     * data_type_size bytes each. as<scalar>() maps them in place, so points
+     * stored as float32 are read as an Eigen::MatrixXf without converting
+     * a value. convert() copies them into a real matrix in one pass.
+     */
+    class StoredData {
+      pqxx::binarystring data_;
+      unsigned int rows_;
+      unsigned int cols_;
+      unsigned int type_size_;
+
+    public:
+      typedef Eigen::Map<const Eigen::MatrixXf> float_frames;
+
+      StoredData(const pqxx::tuple& data_point);
+
+      /** \return frame_dim */
+      unsigned int rows() const;
+      /** \return track_length */
+      unsigned int cols() const;
+      /** \return data_type_size */
+      unsigned int typeSize() const;
+
+      /** \breif The values in place, without a copy.
+       * \throw ErrorInconsistentDataType if they are not of type scalar. */
+      template <class scalar>
+      Eigen::Map<const Eigen::Matrix<scalar, Eigen::Dynamic, Eigen::Dynamic>>
+      as() const;
+
+      float_frames floats() const;
+
+      /** \breif Assigns the values, converted to real, to out.
+       * \throw ErrorInconsistentDataType for an unknown data_type_size. */
+      template <class matrix_type>
+      void convert(matrix_type& out) const;
+    };
+
+    template <class scalar>
+    Eigen::Map<const Eigen::Matrix<scalar, Eigen::Dynamic, Eigen::Dynamic>>
+    StoredData::as() const {
+      if (type_size_ != sizeof(scalar)) {
+        std::stringstream ss;
+        ss << "StoredData: data type size is " << type_size_
+           << " however " << sizeof(scalar) << " was asked";
+        throw ErrorInconsistentDataType(ss.str());
+      }
+
+      typedef Eigen::Matrix<scalar, Eigen::Dynamic, Eigen::Dynamic> raw;
+      return Eigen::Map<const raw>((const scalar*)data_.data(), rows_, cols_);
+    }
+
+    template <class matrix_type>
+    void StoredData::convert(matrix_type& out) const {
+      if (type_size_ == sizeof(float))
+        out = as<float>().template cast<real>();
+      else if (type_size_ == sizeof(double))
+        out = as<double>().template cast<real>();
+      else if (type_size_ == sizeof(long double))
+        out = as<long double>().template cast<real>();
+      else {
+        std::stringstream ss;
+        ss << "Unknown data size " << type_size_;
+        throw ErrorInconsistentDataType(ss.str());
+      }
+    }
+
+  }
+}
+
+#endif
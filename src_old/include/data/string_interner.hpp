@@ -0,0 +1,65 @@
+#ifndef __DATA_STRING_INTERNER_H_
+#define __DATA_STRING_INTERNER_H_
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+namespace track_select {
+  namespace data {
+
+    /** @breif A table holding every string once and numbering them.
+     *
+     *  Equal strings get the same id, so they can be compared, sorted and
+     *  hashed as integers. Ids are given in the order the strings are first
+     *  seen. The table only grows: a string and its id stay valid for the
+     *  lifetime of the process.
+     *
+     *  DataPoint keeps its source data set as an id of sourceDataSets().
+     */
+    class StringInterner {
+    public:
+      typedef unsigned int id_type;
+
+    private:
+      static const unsigned int ChunkSize = 1024;
+      static const unsigned int MaxChunks = 16384;
+
+      std::mutex lock_;
+      std::unordered_map<std::string, id_type> index_;
+
+      /* The strings are in chunks that are never moved, so they are read
+       * without taking the lock */
+      std::atomic<std::string*> chunks_[MaxChunks];
+      std::atomic<id_type> size_;
+
+      /* Tells the tables apart in the per thread cache of intern, even a
+       * new table built where a destroyed one was */
+      unsigned long generation_;
+
+      StringInterner(const StringInterner&);
+      StringInterner& operator=(const StringInterner&);
+    public:
+      StringInterner();
+      ~StringInterner();
+
+      /** @return the id of the string, adding it if it is new
+       *  @note Thread safe. */
+      id_type intern(const std::string& str);
+
+      /** @return the string with the given id
+       *  @note Thread safe, it takes no lock. */
+      const std::string& str(id_type id) const;
+
+      /** @return the number of strings */
+      unsigned int size() const;
+
+      /** @breif The table of the source data sets of all points */
+      static StringInterner& sourceDataSets();
+    };
+
+  }
+}
+
+#endif
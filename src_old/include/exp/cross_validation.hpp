@@ -0,0 +1,54 @@
+#ifndef __EXP_CROSS_VALIDATION_H_
+#define __EXP_CROSS_VALIDATION_H_
+
+#include <track-select>
+#include <map>
+#include <string>
+
+#include "data/data_set_view.hpp"
+
+namespace track_select {
+  namespace exp {
+
+    /** @breif Cross-validates on the folds of a view.
+     *
+     *  The view is split into folds consecutive parts in its order and
+     *  estimate(train, test) is called with each fold as the test part and
+     *  the rest as the training part. The folds are views of the same set,
+     *  no point is copied. check is called on every part before the first
+     *  estimate, so a partition it rejects costs no training.
+     *
+     *  @return every property the estimates report, averaged over the folds.
+     */
+    template <class data_point, class estimate_func, class check_func>
+    optimizer::OptimizerReportItem
+    crossValidate(const data::DataSetView<data_point>& data,
+                  unsigned int folds,
+                  estimate_func estimate,
+                  check_func check) {
+      for (unsigned int k = 0; k < folds; k++) {
+        auto parts = data.fold(k, folds);
+        check(parts.first);
+        check(parts.second);
+      }
+
+      std::map<std::string, real> sums;
+      for (unsigned int k = 0; k < folds; k++) {
+        auto parts = data.fold(k, folds);
+        optimizer::OptimizerReportItem item = estimate(parts.first,
+                                                       parts.second);
+        for (const auto& pair : item.properties())
+          sums[pair.first] += pair.second;
+      }
+
+      optimizer::OptimizerReportItem result;
+      for (const auto& pair : sums)
+        result.setProperty(pair.first, pair.second / folds);
+
+      return result;
+    }
+
+  }
+}
+
+#endif
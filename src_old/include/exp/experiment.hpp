@@ -12,6 +12,7 @@
 
 #include <pqxx/pqxx>
 #include "data/data_set.hpp"
+#include "parallel/thread_pool.hpp"
 
 namespace track_select{
   namespace exp {
@@ -41,6 +42,7 @@ namespace track_select{
       std::string info_;
 
       unsigned int samples_;
+      parallel::ThreadPool* thread_pool_;
 
       std::mutex log_mutex_;
       std::mutex result_mutex_;
@@ -70,9 +72,17 @@ namespace track_select{
       Experiment(unsigned int samples);
       virtual ~Experiment();
 
+      /** \breif Runs the samples on threadPool(), at most as many at a time
+       *  as the pool has threads. A sample can evaluate its objective on the
+       *  same pool. */
       virtual Experiment&
       run(void (*exp)(Experiment*, unsigned int, std::mutex&));
 
+      /** \breif The pool running the samples, ThreadPool::global() unless
+       *  another one is given. The pool is not owned. */
+      Experiment& setThreadPool(parallel::ThreadPool& pool);
+      parallel::ThreadPool& threadPool() const;
+
       virtual database_id store(pqxx::work& work) const;
       virtual std::string info() const;
       virtual std::string fingerPrint() const;
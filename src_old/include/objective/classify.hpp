@@ -3,6 +3,8 @@
 #include <track-select>
 #include <set>
 
+#include "parallel/thread_pool.hpp"
+
 namespace track_select {
   namespace objective {
     template<class data_container>
@@ -30,6 +32,7 @@ namespace track_select {
       unsigned int input_dim_;
       unsigned int categories_count_;
       bool parallel_exec_;
+      parallel::ThreadPool* thread_pool_;
       mutable unsigned int generation_counter_;
     public:
       Classify(unsigned int p_size,
@@ -50,8 +53,20 @@ namespace track_select {
       virtual optimizer::OptimizerReportItem
       buildItem(const std::vector<std::tuple<unsigned short, Vector>> &cls) const;
 
+      /** @breif The item of the categories assigned to the points and the
+       *  class probabilities predicted for them, a column per point */
+      virtual optimizer::OptimizerReportItem
+      buildItem(const std::vector<unsigned short>& categories,
+                const Matrix& probabilities) const;
+
       virtual void setParallelExec(bool exec);
 
+      /** @breif The pool evaluating the population when parallelExec() is
+       *  set, ThreadPool::global() unless another one is given. The pool is
+       *  not owned. */
+      virtual void setThreadPool(parallel::ThreadPool& pool);
+      parallel::ThreadPool& threadPool() const;
+
       inline FitnessType type() const;
       inline unsigned int categoriesCount() const;
       inline unsigned int inputDim() const;
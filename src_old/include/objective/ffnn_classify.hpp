@@ -2,7 +2,9 @@
 #define __OBJECTIVE_FFNN_CLASSIFY_H_
 
 #include "objective/classify.hpp"
+#include "objective/param_layout.hpp"
 #include "data/feature_vector_set.hpp"
+#include "data/data_set_view.hpp"
 
 namespace track_select {
   namespace objective {
@@ -11,10 +13,31 @@ namespace track_select {
     unsigned short readTarget(const real* results, unsigned int c_size);
 
     class FFNNClassify : public Classify {
+      typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> MatrixF;
+
       unsigned int hidden_units_count_;
 
+      /* The blocks of the network in the params of a candidate */
+      ParamLayout layout_;
+      unsigned int hidden_weights_;
+      unsigned int hidden_biases_;
+      unsigned int output_weights_;
+      unsigned int output_biases_;
+
+      /* The points as columns of one matrix and their categories, built
+       * once and shared by the clones. In single precision only the float
+       * copy is kept. */
+      std::shared_ptr<const Matrix> inputs_;
+      std::shared_ptr<const MatrixF> inputs_float_;
+      std::shared_ptr<const std::vector<unsigned short>> targets_;
+
+      template <class matrix_type>
+      Matrix forward(const Vector& params, const matrix_type& inputs) const;
+
+      void readInputs();
+
     protected:
-      const data::FeatureVectorSet * data_;
+      data::FeatureVectorSetView data_;
 
     public:
       /* @breif Objective function for Neural Network
@@ -24,6 +47,14 @@ namespace track_select {
                    FitnessType fitness_type,
                    const data::FeatureVectorSet & data);
 
+      /* @breif Objective function on the points of a view, for example a
+       * cross-validation fold, without copying them
+       */
+      FFNNClassify(unsigned int population_size,
+                   unsigned int hidden_units,
+                   FitnessType fitness_type,
+                   const data::FeatureVectorSetView& data);
+
       FFNNClassify(const FFNNClassify& obj);
       virtual FFNNClassify& operator=(const FFNNClassify& obj);
 
@@ -32,8 +63,21 @@ namespace track_select {
 
       virtual nn::FeedForwardNetwork buildFromParams(const Vector& params) const;
 
+      /** @breif The softmax of the network outputs for every point of data(),
+       *  a column per point. The network is not built, all points go
+       *  through each layer as one matrix product. */
+      virtual Matrix classProbabilities(const Vector& params) const;
+
+      /** @breif Evaluates the network in float instead of real. It is faster
+       *  and the points are kept only as floats, in half the memory, but the
+       *  fitness is only as precise as a float. Going back to real reads the
+       *  points from data() again. */
+      virtual void setSinglePrecision(bool single);
+      bool singlePrecision() const;
+
       inline unsigned int hiddenUnitsCount() const;
-      virtual const data::FeatureVectorSet& data() const;
+      inline const ParamLayout& layout() const;
+      virtual const data::FeatureVectorSetView& data() const;
 
       virtual FFNNClassify* clone() const;
       static unsigned int calcParamsCount(unsigned int input_dim,
@@ -45,6 +89,10 @@ namespace track_select {
       return hidden_units_count_;
     }
 
+    const ParamLayout& FFNNClassify::layout() const {
+      return layout_;
+    }
+
 
   }
 }
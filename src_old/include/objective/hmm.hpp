@@ -3,16 +3,54 @@
 
 #include "objective/classify.hpp"
 #include "data/sequence_set.hpp"
+#include "data/data_set_view.hpp"
+#include "data/sequence_arena.hpp"
+#include "objective/hmm_forward.hpp"
+
+#include <memory>
 
 namespace track_select {
   namespace objective {
 
     class HMM : public Classify {
+    public:
+      typedef std::vector<std::vector<nn::FeedForwardNetwork::layer>>
+        emission_type;
+
+      /** @breif The parameters of the model of one category */
+      struct Model {
+        Vector pi;
+        Matrix tr;
+        emission_type em;
+      };
+
     private:
       unsigned int hidden_units_count_;
       unsigned int hidden_states_count_;
+
+      /* The blocks of the models in the params of a candidate, by category
+       * and, for the emissions, by state */
+      struct StateBlocks {
+        unsigned int hidden_biases;
+        unsigned int hidden_weights;
+        unsigned int output_bias;
+        unsigned int output_weights;
+      };
+      struct CategoryBlocks {
+        unsigned int pi;
+        unsigned int tr;
+        std::vector<StateBlocks> states;
+      };
+      ParamLayout layout_;
+      std::vector<CategoryBlocks> blocks_;
+
+      void buildLayout();
+      Model modelFromParams(const Vector& params, unsigned int category) const;
     protected:
-      const data::SequenceSet* data_;
+      data::SequenceSetView data_;
+      /* The same sequences packed for the sweeps of operator() */
+      std::shared_ptr<const data::SequenceArena> arena_;
+      std::shared_ptr<const HMMForward> forward_;
       Vector priors_;
     public:
       /* @breif Objective function for Neural Network
@@ -23,6 +61,15 @@ namespace track_select {
           FitnessType fitness_type,
           const data::SequenceSet& data);
 
+      /* @breif Objective function on the points of a view, for example a
+       * cross-validation fold, without copying them
+       */
+      HMM(unsigned int population_size,
+          unsigned int hidden_units,
+          unsigned int hidden_states,
+          FitnessType fitness_type,
+          const data::SequenceSetView& data);
+
       HMM(const HMM& obj);
 
       virtual HMM& operator=(const HMM& obj);
@@ -34,9 +81,14 @@ namespace track_select {
       virtual std::vector<hmm::NNHMM>
       buildFromParams(const Vector& params) const;
 
+      /** @breif The normalised parameters of the model of every category,
+       *  as buildFromParams reads them */
+      virtual std::vector<Model> modelsFromParams(const Vector& params) const;
+
       inline unsigned int hiddenUnitsCount() const;
       inline unsigned int hiddenStatesCount() const;
-      inline const data::SequenceSet& data() const;
+      inline const ParamLayout& layout() const;
+      inline const data::SequenceSetView& data() const;
 
       virtual HMM* clone() const;
     };
@@ -50,8 +102,12 @@ namespace track_select {
       return hidden_states_count_;
     }
 
-    const data::SequenceSet& HMM::data() const {
-      return *data_;
+    const ParamLayout& HMM::layout() const {
+      return layout_;
+    }
+
+    const data::SequenceSetView& HMM::data() const {
+      return data_;
     }
   }
 }
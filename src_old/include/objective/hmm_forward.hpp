@@ -0,0 +1,101 @@
+#ifndef __OBJECTIVE_HMM_FORWARD_H_
+#define __OBJECTIVE_HMM_FORWARD_H_
+
+#include <track-select>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "data/sequence_arena.hpp"
+#include "objective/param_layout.hpp"
+
+namespace track_select {
+  namespace objective {
+
+    /** @breif The forward algorithm run on all sequences of an arena at once.
+     *
+     *  The emissions of every frame under every state are computed first, as
+     *  a states x frames matrix taken from the frames of the arena with a few
+     *  matrix products. The recursion then advances a batch of sequences
+     *  together, one column of alpha per sequence, so a step is a single
+     *  product with the transition matrix. The sequences are batched by
+     *  decreasing length and a batch shrinks as its shorter sequences end.
+     *
+     *  The emissions are taken as logarithms and scaled frame by frame, and
+     *  alpha is normalised at every step, so long sequences and narrow
+     *  densities do not underflow.
+     *
+     *  The models are given by their parameters: pi, tr with tr(i, j) the
+     *  probability to move from state i to state j, and the emissions of
+     *  NNHMM, GHMM or DiscreteHMM. Other emissions are passed as log
+     *  emissions.
+     */
+    class HMMForward {
+    public:
+      /** @breif The emission network of one NNHMM state, a sigmoid hidden
+       *  layer and a single sigmoid output, viewed in a parameter vector */
+      struct NNEmissionView {
+        ParamLayout::MatrixView hidden_weights;
+        ParamLayout::VectorView hidden_biases;
+        ParamLayout::MatrixView output_weights;
+        ParamLayout::VectorView output_bias;
+      };
+
+    private:
+      std::shared_ptr<const data::SequenceArena> arena_;
+      unsigned int lanes_;
+
+      /* The sequences by decreasing length */
+      std::vector<unsigned int> order_;
+
+    public:
+      /** @param lanes the number of sequences advanced together */
+      HMMForward(const std::shared_ptr<const data::SequenceArena>& arena,
+                 unsigned int lanes = 64);
+
+      const data::SequenceArena& arena() const;
+
+      /** @return the log likelihood of every sequence of the arena, -inf for
+       *  a sequence impossible under the model
+       *  @param log_emissions the log probability of frame f under state s
+       *  at (s, f), a column per column of arena().frames() */
+      Vector logLikelihood(const Vector& pi, const Matrix& tr,
+                           const Matrix& log_emissions) const;
+
+      template <class em_type>
+      Vector logLikelihood(const Vector& pi, const Matrix& tr,
+                           const em_type& em) const {
+        return logLikelihood(pi, tr, logEmissions(em, arena_->frames()));
+      }
+
+      /** @name Log emissions of all frames, a column per frame */
+      /** @{ */
+      /** @breif NNHMM, a network per state. The output layer must be a
+       *  single sigmoid unit.
+       *  @throw hmm::ErrorHMM for another output activation */
+      static Matrix logEmissions(
+        const std::vector<std::vector<nn::FeedForwardNetwork::layer>>& em,
+        const Matrix& frames);
+
+      /** @breif NNHMM with the networks read in place */
+      static Matrix logEmissions(const std::vector<NNEmissionView>& em,
+                                 const Matrix& frames);
+
+      /** @breif GHMM, a mean and a covariance per state
+       *  @throw hmm::ErrorHMM for a covariance that is not positive definite */
+      static Matrix logEmissions(
+        const std::vector<std::tuple<Vector, Matrix>>& em,
+        const Matrix& frames);
+
+      /** @breif DiscreteHMM, symbols x states probabilities. The symbol is
+       *  the first value of the frame, a symbol outside the table has log
+       *  emission -inf. logLikelihood takes any Matrix as log emissions, so
+       *  the table is passed through this first. */
+      static Matrix logEmissions(const Matrix& em, const Matrix& frames);
+      /** @} */
+    };
+
+  }
+}
+
+#endif
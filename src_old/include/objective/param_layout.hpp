@@ -0,0 +1,60 @@
+#ifndef __OBJECTIVE_PARAM_LAYOUT_H_
+#define __OBJECTIVE_PARAM_LAYOUT_H_
+
+#include <track-select>
+#include <vector>
+
+namespace track_select {
+  namespace objective {
+
+    /** @breif Where the matrices and vectors of a model are in its parameter
+     *  vector.
+     *
+     *  A layout lists the blocks of the model in the order they are read
+     *  from the parameters of a candidate, a matrix being read row after
+     *  row, and gives them as Eigen::Map views of the parameters. The
+     *  weights are read in place instead of being copied one parameter at a
+     *  time. What a model derives from them, normalised probabilities or
+     *  weights in another precision, it still builds per candidate.
+     */
+    class ParamLayout {
+    public:
+      typedef Eigen::Matrix<real, Eigen::Dynamic, Eigen::Dynamic,
+                            Eigen::RowMajor> RowMajorMatrix;
+      typedef Eigen::Map<const RowMajorMatrix> MatrixView;
+      typedef Eigen::Map<const Vector> VectorView;
+
+    private:
+      struct Block {
+        unsigned int offset;
+        unsigned int rows;
+        unsigned int cols;
+      };
+
+      std::vector<Block> blocks_;
+      unsigned int size_;
+
+      void check(const Vector& params) const;
+
+    public:
+      ParamLayout();
+
+      /** @breif Appends a rows x cols block
+       *  @return the index of the block */
+      unsigned int add(unsigned int rows, unsigned int cols = 1);
+
+      /** @return the number of parameters of all blocks */
+      unsigned int size() const;
+      unsigned int offset(unsigned int block) const;
+
+      /** @breif The block as a matrix or, for a single column, a vector,
+       *  viewed in place.
+       *  @throw ErrorInconsistentDim if params is shorter than size() */
+      MatrixView matrix(const Vector& params, unsigned int block) const;
+      VectorView vector(const Vector& params, unsigned int block) const;
+    };
+
+  }
+}
+
+#endif
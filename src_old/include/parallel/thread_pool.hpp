@@ -0,0 +1,83 @@
+#ifndef __PARALLEL_THREAD_POOL_H_
+#define __PARALLEL_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace track_select {
+  namespace parallel {
+
+    /** @breif A fixed set of threads running the iterations of parallel
+     *  loops.
+     *
+     *  A loop is split into chunks of consecutive iterations. The calling
+     *  thread runs chunks of its own loop and the idle workers steal the
+     *  rest: each worker keeps the loops it started in its own queue, taking
+     *  the newest first, and takes the oldest loop of another queue when its
+     *  own is empty. Loops may be nested, an iteration may start a loop of
+     *  its own on the same pool. A thread waiting for its loop only runs
+     *  chunks of that loop, so it never picks up unrelated work while it
+     *  holds a lock.
+     *
+     *  The threads are started once and sleep while there is no loop.
+     */
+    class ThreadPool {
+      class Loop;
+
+      struct Queue {
+        std::mutex lock;
+        std::deque<std::shared_ptr<Loop>> loops;
+      };
+
+      /* One queue per worker and the last one for threads outside the
+       * pool */
+      std::vector<std::unique_ptr<Queue>> queues_;
+      std::vector<std::thread> workers_;
+
+      std::mutex sleep_lock_;
+      std::condition_variable wake_;
+      unsigned long epoch_;
+      bool stop_;
+
+      ThreadPool(const ThreadPool&);
+      ThreadPool& operator=(const ThreadPool&);
+
+      void work(unsigned int me);
+      bool steal(unsigned int me);
+      void remove(Queue& queue, const std::shared_ptr<Loop>& loop);
+      unsigned int queueOfCaller() const;
+
+    public:
+      /** @breif Starts threads - 1 workers, the thread calling parallelFor
+       *  being the last one. With threads 0 or 1 the loops run in the
+       *  calling thread. */
+      ThreadPool(unsigned int threads);
+      ~ThreadPool();
+
+      /** @return the number of threads running loops, the caller included */
+      unsigned int size() const;
+
+      /** @breif Calls body(i) for i in [begin, end) on the threads of the
+       *  pool and returns when all calls returned.
+       *  @param chunk the number of consecutive iterations taken at a time,
+       *  0 to split the range into a few chunks per thread.
+       *  @throw the first exception thrown by body, after all chunks ran. */
+      void parallelFor(unsigned int begin, unsigned int end, unsigned int chunk,
+                       const std::function<void(unsigned int)>& body);
+
+      /** @breif The pool shared by the objectives and experiments, with a
+       *  thread per hardware thread. */
+      static ThreadPool& global();
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include "data/bulk_insert.hpp"
+
+#include <stdexcept>
+
+namespace track_select {
+  namespace data {
+    BulkInsert::BulkInsert(pqxx::work& work,
+                           const std::string& table,
+                           const std::vector<std::string>& columns,
+                           unsigned int rows_per_insert,
+                           size_t bytes_per_insert)
+      : work_(work),
+        columns_(columns.size()),
+        rows_per_insert_(rows_per_insert),
+        bytes_per_insert_(bytes_per_insert),
+        rows_(0),
+        fields_(0) {
+
+      std::stringstream head;
+      head << "insert into " << table << " (";
+      for (unsigned int i = 0; i < columns.size(); i++)
+        head << (i ? ", " : "") << columns[i];
+      head << ") values ";
+      head_ = head.str();
+    }
+
+    BulkInsert& BulkInsert::field(const std::string& sql) {
+      values_ += fields_ ? ", " : (rows_ ? ", (" : "(");
+      values_ += sql;
+
+      if (++fields_ < columns_) return *this;
+
+      values_ += ")";
+      fields_ = 0;
+      rows_++;
+
+      if (rows_ >= rows_per_insert_ || values_.size() >= bytes_per_insert_)
+        flush();
+
+      return *this;
+    }
+
+    BulkInsert& BulkInsert::operator()() {
+      return field("null");
+    }
+
+    BulkInsert& BulkInsert::operator()(const pqxx::binarystring& value) {
+      return bytea(value.data(), value.size());
+    }
+
+    BulkInsert& BulkInsert::bytea(const void* data, size_t size) {
+      return field("'" + work_.esc_raw((const unsigned char*)data, size) +
+                   "'::bytea");
+    }
+
+    void BulkInsert::flush() {
+      if (fields_)
+        throw std::logic_error("BulkInsert: flush in the middle of a row");
+      if (!rows_) return;
+
+      work_.exec(head_ + values_);
+      values_.clear();
+      rows_ = 0;
+    }
+
+    unsigned int BulkInsert::pending() const {
+      return rows_;
+    }
+
+  }
+}
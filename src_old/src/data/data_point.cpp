@@ -30,7 +30,7 @@ namespace track_select {
         source_track_id_set_(obj.source_track_id_set_),
         source_track_id_(obj.source_track_id_),
 
-        source_range_set_(obj.source_data_set_set_),
+        source_range_set_(obj.source_range_set_),
         source_range_(obj.source_range_),
 
         category_set_(obj.category_set_),
@@ -124,15 +124,28 @@ namespace track_select {
       return source_data_set_set_;
     }
 
-    std::string DataPoint::sourceDataSet() const {
+    const std::string& DataPoint::sourceDataSet() const {
       if (!sourceDataSetSet())
         throw ErrorAttributeNotSet("DataPoint::sourceDataSet");
 
-      return source_data_set_;
+      return StringInterner::sourceDataSets().str(source_data_set_);
     }
 
     void DataPoint::setSourceDataSet(const std::string& set) {
-      source_data_set_ = set;
+      source_data_set_ = StringInterner::sourceDataSets().intern(set);
+      source_data_set_set_ = true;
+    }
+
+    StringInterner::id_type DataPoint::sourceDataSetId() const {
+      if (!sourceDataSetSet())
+        throw ErrorAttributeNotSet("DataPoint::sourceDataSet");
+
+      return source_data_set_;
+    }
+
+    void DataPoint::setSourceDataSetId(StringInterner::id_type id) {
+      StringInterner::sourceDataSets().str(id);
+      source_data_set_ = id;
       source_data_set_set_ = true;
     }
 
@@ -228,7 +241,7 @@ namespace track_select {
         (foreignKeyId())
         (size())
         (dim())
-        (data())
+        (pqxx::binarystring(values(), size()*dim()*sizeof(real)))
         (size()*dim())
         (sizeof(real)).exec();
 
@@ -277,6 +290,52 @@ namespace track_select {
       return id;
     }
 
+    const std::vector<std::string>& DataPoint::storeColumns() {
+      static const std::vector<std::string> columns = {
+        "sequence_set_id",
+        "track_length",
+        "frame_dim",
+        "data",
+        "data_size",
+        "data_type_size",
+        "category",
+        "source_data_set",
+        "source_track_id",
+        "source_range_low",
+        "source_range_high"};
+      return columns;
+    }
+
+    void DataPoint::storeRow(BulkInsert& rows, database_id set_id,
+                             unsigned int data_type_size) const {
+      unsigned int count = size()*dim();
+
+      rows(set_id)(size())(dim());
+      if (data_type_size == sizeof(real)) {
+        rows.bytea(values(), count*sizeof(real));
+      } else if (data_type_size == sizeof(float)) {
+        Eigen::VectorXf narrowed =
+          Eigen::Map<const Vector>(values(), count).cast<float>();
+        rows.bytea(narrowed.data(), count*sizeof(float));
+      } else {
+        std::stringstream ss;
+        ss << "Unknown data size " << data_type_size;
+        throw ErrorInconsistentDataType(ss.str());
+      }
+      rows(count)(data_type_size);
+
+      if (categorySet()) rows(category()); else rows();
+      if (sourceDataSetSet()) rows(sourceDataSet()); else rows();
+      if (sourceTrackIdSet()) rows(sourceTrackId()); else rows();
+
+      if (sourceRangeSet()) {
+        const msmm::CustomRange& range = sourceRange();
+        rows(range.low())(range.high());
+      } else {
+        rows()();
+      }
+    }
+
 
   }
 }
@@ -1,11 +1,14 @@
 #include "data/data_set.hpp"
 #include "data/feature_vector.hpp"
 #include "data/sequence.hpp"
+#include "data/data_set_cache.hpp"
 
 #include <cstddef>
 #include <functional>
 #include <algorithm>
 #include <sstream>
+#include <exception>
+#include <iostream>
 
 
 namespace track_select {
@@ -120,45 +123,39 @@ namespace track_select {
 
     template <class data_point>
     void DataSet<data_point>::setDim(unsigned int dim) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       setDimUnsafe(dim);
-      lock_.unlock();
     }
 
     template <class data_point>
     void DataSet<data_point>::setInfo(const std::string& info) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       setInfoUnsafe(info);
-      lock_.unlock();
     }
 
 
     template <class data_point>
     void DataSet<data_point>::setFrameInfo(const std::vector<std::string>& frame_info) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       setFrameInfoUnsafe(frame_info);
-      lock_.unlock();
     }
 
     template<class data_point>
     void DataSet<data_point>::setDimIfNotSet(unsigned int dim) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       if (!dimSet()) setDimUnsafe(dim);
-      lock_.unlock();
     }
 
     template<class data_point>
     void DataSet<data_point>::setInfoIfNotSet(const std::string& info) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       if (!infoSet()) setInfoUnsafe(info);
-      lock_.unlock();
     }
 
     template<class data_point>
     void DataSet<data_point>::setFrameInfoIfNotSet(const std::vector<std::string>& i) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       if (!frameInfoSet()) setFrameInfoUnsafe(i);
-      lock_.unlock();
     }
 
 
@@ -192,7 +189,7 @@ namespace track_select {
 
     template <class data_point>
     DataSet<data_point>& DataSet<data_point>::operator<<(const data_point& dp) {
-      lock_.lock();
+      std::lock_guard<std::mutex> lock(lock_);
       try {
         if (dim() != dp.dim()) {
           std::stringstream ss;
@@ -209,14 +206,89 @@ namespace track_select {
       data_points_.back().setOwner(this);
       data_points_.back().clearId();
 
-      lock_.unlock();
       return *this;
 
     }
 
     template <class data_point>
     DataSet<data_point>&
-    DataSet<data_point>::addDataPointWithId(const data_point& dp) {
+    DataSet<data_point>::merge(std::vector<DataSetBuilder<data_point>>& builders) {
+      std::lock_guard<std::mutex> lock(lock_);
+
+      /* All builders are checked before the set is changed */
+      bool dim_set = dimSet();
+      unsigned int dim = dim_set ? this->dim() : 0;
+      unsigned int size = data_points_.size();
+      for (auto& builder : builders) {
+        if (!builder.points_.size()) continue;
+        if (!dim_set) {
+          dim = builder.dim_;
+          dim_set = true;
+        }
+        if (dim != builder.dim_) {
+          std::stringstream ss;
+          ss << "DataSet: data dim should be " << dim
+             << " however it is " << builder.dim_;
+          throw ErrorInconsistentDim(ss.str());
+        }
+        size += builder.points_.size();
+      }
+
+      if (dim_set && !dimSet()) setDimUnsafe(dim);
+      data_points_.reserve(size);
+      for (auto& builder : builders) {
+        for (auto& point : builder.points_) {
+          data_points_.push_back(std::move(point));
+          data_points_.back().setOwner(this);
+          data_points_.back().clearId();
+        }
+        builder.points_.clear();
+      }
+
+      return *this;
+    }
+
+    template <class data_point>
+    DataSet<data_point>&
+    DataSet<data_point>::merge(DataSetBuilder<data_point>& builder) {
+      std::vector<DataSetBuilder<data_point>> builders(1);
+      std::swap(builders[0], builder);
+      return merge(builders);
+    }
+
+    template <class data_point>
+    DataSetBuilder<data_point>::DataSetBuilder() : dim_set_(false) {}
+
+    template <class data_point>
+    DataSetBuilder<data_point>&
+    DataSetBuilder<data_point>::operator<<(const data_point& dp) {
+      if (!dim_set_) {
+        dim_ = dp.dim();
+        dim_set_ = true;
+      } else if (dim_ != dp.dim()) {
+        std::stringstream ss;
+        ss << "DataSetBuilder: data dim should be " << dim_
+           << " however it is " << dp.dim();
+        throw ErrorInconsistentDim(ss.str());
+      }
+
+      points_.push_back(dp);
+      return *this;
+    }
+
+    template <class data_point>
+    void DataSetBuilder<data_point>::reserve(unsigned int size) {
+      points_.reserve(size);
+    }
+
+    template <class data_point>
+    unsigned int DataSetBuilder<data_point>::size() const {
+      return points_.size();
+    }
+
+    template <class data_point>
+    DataSet<data_point>&
+    DataSet<data_point>::addDataPointWithId(data_point&& dp) {
       try {
         if (dim() != dp.dim()) {
           std::stringstream ss;
@@ -228,10 +300,11 @@ namespace track_select {
         setDim(dp.dim());
       }
 
-      data_points_.push_back(dp);
+      database_id id = dp.id();
+      data_points_.push_back(std::move(dp));
       data_points_.back().setOwner(this);
       if (!data_points_.back().hasId())
-        data_points_.back().setId(dp.id());
+        data_points_.back().setId(id);
       return *this;
     }
 
@@ -286,20 +359,16 @@ namespace track_select {
 
     template <class data_point>
     typename DataSet<data_point>::iterator DataSet<data_point>::erase(iterator el) {
-      lock_.lock();
-      auto res = data_points_.erase((typename data_container::iterator)el);
-      lock_.unlock();
-      return res;
+      std::lock_guard<std::mutex> lock(lock_);
+      return data_points_.erase((typename data_container::iterator)el);
     }
 
     template <class data_point>
     typename DataSet<data_point>::iterator
     DataSet<data_point>::erase(iterator begin, iterator end) {
-      lock_.lock();
-      auto res = data_points_.erase((typename data_container::iterator)begin,
-                                    (typename data_container::iterator)end);
-      lock_.unlock();
-      return res;
+      std::lock_guard<std::mutex> lock(lock_);
+      return data_points_.erase((typename data_container::iterator)begin,
+                                (typename data_container::iterator)end);
     }
 
 
@@ -317,8 +386,20 @@ namespace track_select {
 
     template <class data_point>
     database_id DataSet<data_point>::store(pqxx::work& work) const {
+      return store(work, sizeof(real));
+    }
+
+    template <class data_point>
+    database_id DataSet<data_point>::store(pqxx::work& work,
+                                           unsigned int data_type_size) const {
+      database_id db_id = storeHeader(work);
+      storePoints(db_id, work, data_type_size);
+      return db_id;
+    }
+
+    template <class data_point>
+    database_id DataSet<data_point>::storeHeader(pqxx::work& work) const {
       if (hasId()) throw ErrorRecordAlreadyExists();
-      pqxx::connection conn("");
 
 
       work.conn().prepare("insert_sequence_set", "insert into sequence_set \
@@ -346,23 +427,26 @@ namespace track_select {
           ().exec();
       }
 
-      for (auto sequence : *this) {
-        sequence.setForeignKeyId(db_id);
-        sequence.store(work);
-      }
-
       return db_id;
     }
 
+    template <class data_point>
+    void DataSet<data_point>::storePoints(database_id set_id,
+                                          pqxx::work& work,
+                                          unsigned int data_type_size) const {
+      BulkInsert rows(work, "sequence", data_point::storeColumns());
+      for (auto& point : *this)
+        point.storeRow(rows, set_id, data_type_size);
+      rows.flush();
+    }
+
     template <class data_point> DataSet<data_point>
-    DataSet<data_point>::read(database_id id, pqxx::work& work) {
+    DataSet<data_point>::readHeader(database_id id, pqxx::work& work,
+                                    std::string* stamp) {
 
       work.conn().prepare("select_data_set",
                    "select * from sequence_set where id = $1");
 
-      work.conn().prepare("select_data_point_ids",
-                   "select id from sequence where sequence_set_id = $1 order by id");
-
       /* Refers by primary key and therefore the result is always 1 tuple */
       pqxx::result data_sets = work.prepared("select_data_set")(id).exec();
       if (!data_sets.size())
@@ -382,17 +466,84 @@ namespace track_select {
         data_set.setFrameInfo(frame_info);
       }
 
+      if (stamp && !data_sets[0]["created_at"].is_null())
+        *stamp = data_sets[0]["created_at"].as<std::string>();
+
+      return data_set;
+    }
+
+    /* One cursor over the records of the set instead of a query per point */
+    static pqxx::icursorstream* openRecords(database_id id, pqxx::work& work,
+                                            unsigned int batch_size) {
+      std::stringstream query;
+      query << "select * from sequence where sequence_set_id = " << id
+            << " order by id";
 
-      pqxx::result data_points = work.prepared("select_data_point_ids")(id).exec();
+      std::stringstream cursor;
+      cursor << "data_set_" << id;
 
-      for (auto record : data_points) {
-        data_point p = data_point::read(record["id"].as<database_id>(), work);
-        data_set.addDataPointWithId(p);
+      return new pqxx::icursorstream(work, query.str(), cursor.str(), batch_size);
+    }
+
+    template <class data_point> DataSet<data_point>
+    DataSet<data_point>::read(database_id id, pqxx::work& work,
+                              unsigned int batch_size) {
+      std::string stamp;
+      DataSet<data_point> data_set = readHeader(id, work, &stamp);
+
+      std::unique_ptr<DataSetCache> cache(DataSetCache::fromEnvironment());
+      if (cache) {
+        try {
+          if (cache->load(id, stamp, data_set)) return data_set;
+        } catch (ErrorDataSetCache e) {
+          /* A damaged copy is read again from the database */
+          std::cerr << "Warning: " << e.what() << std::endl;
+          data_set = readHeader(id, work);
+        }
       }
 
+      std::unique_ptr<pqxx::icursorstream> records(openRecords(id, work, batch_size));
+      for (pqxx::result batch; *records >> batch; )
+        data_set.addRecords(batch);
+
+      if (cache) {
+        try {
+          cache->save(data_set, stamp);
+        } catch (ErrorDataSetCache e) {
+          std::cerr << "Warning: " << e.what() << std::endl;
+        }
+      }
       return data_set;
     }
 
+    template <class data_point> DataSetStream<data_point>
+    DataSet<data_point>::stream(database_id id, pqxx::work& work,
+                                unsigned int batch_size) {
+      return DataSetStream<data_point>(id, work, batch_size);
+    }
+
+    template <class data_point>
+    void DataSet<data_point>::addRecords(const pqxx::result& records) {
+      std::vector<data_point> points(records.size());
+      std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic, 16)
+      for (unsigned int i = 0; i < records.size(); i++) {
+        try {
+          points[i] = data_point(records[i]);
+        } catch (...) {
+#pragma omp critical
+          error = std::current_exception();
+        }
+      }
+
+      if (error) std::rethrow_exception(error);
+
+      data_points_.reserve(data_points_.size() + points.size());
+      for (auto& point : points)
+        addDataPointWithId(std::move(point));
+    }
+
 
     template <class data_point>
     void DataSet<data_point>::zero_class_check(const DataSet<data_point>& v_set)  {
@@ -408,8 +559,35 @@ namespace track_select {
     }
 
 
+    template <class data_point>
+    DataSetStream<data_point>::DataSetStream(database_id id, pqxx::work& work,
+                                             unsigned int batch_size)
+      : header_(DataSet<data_point>::readHeader(id, work)),
+        records_(openRecords(id, work, batch_size)) {}
+
+    template <class data_point>
+    const DataSet<data_point>& DataSetStream<data_point>::header() const {
+      return header_;
+    }
+
+    template <class data_point>
+    bool DataSetStream<data_point>::next(DataSet<data_point>& batch) {
+      batch = header_;
+
+      pqxx::result records;
+      if (!(*records_ >> records)) return false;
+
+      batch.addRecords(records);
+      return true;
+    }
+
+
     template class DataSet<Sequence>;
     template class DataSet<FeatureVector>;
+    template class DataSetStream<Sequence>;
+    template class DataSetStream<FeatureVector>;
+    template class DataSetBuilder<Sequence>;
+    template class DataSetBuilder<FeatureVector>;
   }
 
 }
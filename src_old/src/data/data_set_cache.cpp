@@ -0,0 +1,400 @@
+#include "data/data_set_cache.hpp"
+#include "data/sequence.hpp"
+#include "data/feature_vector.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace track_select {
+  namespace data {
+
+    ErrorDataSetCache::ErrorDataSetCache(const std::string& str)
+      : std::runtime_error(str) {}
+
+    const unsigned int DataSetCache::Version = 2;
+
+    namespace {
+      const char Magic[8] = {'T', 'S', 'C', 'A', 'C', 'H', 'E', '\0'};
+      const char Prefix[] = "data-set-";
+      const char Suffix[] = ".cache";
+
+      const std::uint32_t NotSet = std::numeric_limits<std::uint32_t>::max();
+      const std::uint32_t RangeSet = 1;
+
+      /* Numbers the files written aside, so threads of one process saving
+       * the same set do not write to the same file */
+      std::atomic<unsigned long> aside_count(0);
+
+      struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t real_size;
+        std::uint64_t id;
+        std::uint64_t points;
+        std::uint64_t columns;
+        std::uint32_t dim;
+        std::uint32_t dim_set;
+        std::uint32_t point_type;
+        std::uint32_t reserved;
+      };
+
+      /* Sequence and feature vector sets are read from the same table, so
+       * one id can be cached as either of them */
+      std::uint32_t pointType(const Sequence*) { return 1; }
+      std::uint32_t pointType(const FeatureVector*) { return 2; }
+
+      /* Every section starts at a multiple of 8 bytes */
+      size_t aligned(size_t size) {
+        return (size + 7) & ~(size_t)7;
+      }
+
+      class Writer {
+        std::ofstream out_;
+        size_t written_;
+      public:
+        Writer(const std::string& path)
+          : out_(path.c_str(), std::ios::binary | std::ios::trunc),
+            written_(0) {
+          if (!out_) throw ErrorDataSetCache("DataSetCache: cannot write " + path);
+        }
+
+        /* Appends to the current section */
+        void append(const void* data, size_t size) {
+          out_.write((const char*)data, size);
+          written_ += size;
+        }
+
+        /* Ends the current section */
+        void pad() {
+          static const char zeros[8] = {0};
+          out_.write(zeros, aligned(written_) - written_);
+          written_ = aligned(written_);
+        }
+
+        void write(const void* data, size_t size) {
+          append(data, size);
+          pad();
+        }
+
+        template <class value_type>
+        void write(const std::vector<value_type>& column) {
+          write(column.data(), column.size() * sizeof(value_type));
+        }
+
+        void write(const std::string& str) {
+          std::uint64_t size = str.size();
+          write(&size, sizeof(size));
+          write(str.data(), str.size());
+        }
+
+        void write(const std::vector<std::string>& strs) {
+          std::uint64_t size = strs.size();
+          write(&size, sizeof(size));
+          for (auto& str : strs) write(str);
+        }
+
+        void close() {
+          out_.close();
+          if (!out_) throw ErrorDataSetCache("DataSetCache: write failed");
+        }
+      };
+
+      /* Reads the sections of a mapped file, checking its bounds */
+      class Reader {
+        const char* data_;
+        size_t size_;
+        size_t read_;
+      public:
+        Reader(const void* data, size_t size)
+          : data_((const char*)data), size_(size), read_(0) {}
+
+        const void* read(size_t size) {
+          if (read_ + size > size_)
+            throw ErrorDataSetCache("DataSetCache: file is truncated");
+          const void* at = data_ + read_;
+          read_ = aligned(read_ + size);
+          return at;
+        }
+
+        template <class value_type>
+        const value_type* column(size_t count) {
+          return (const value_type*)read(count * sizeof(value_type));
+        }
+
+        std::string string() {
+          std::uint64_t size = *column<std::uint64_t>(1);
+          return std::string((const char*)read(size), size);
+        }
+
+        std::vector<std::string> strings() {
+          std::uint64_t count = *column<std::uint64_t>(1);
+          std::vector<std::string> strs;
+          for (std::uint64_t i = 0; i < count; i++) strs.push_back(string());
+          return strs;
+        }
+      };
+
+      /* The file stays mapped while it is read. The descriptor is closed
+       * once the file is mapped. */
+      class Mapping {
+        void* data_;
+        size_t size_;
+      public:
+        Mapping(int fd, size_t size) : size_(size) {
+          data_ = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+          close(fd);
+          if (data_ == MAP_FAILED)
+            throw ErrorDataSetCache("DataSetCache: cannot map the file");
+        }
+        ~Mapping() { munmap(data_, size_); }
+
+        const void* data() const { return data_; }
+      };
+
+      unsigned int frameCount(const Sequence& point) { return point.size(); }
+      unsigned int frameCount(const FeatureVector& point) { return 1; }
+
+      const real* frameData(const Sequence& point) { return point.matrix().data(); }
+      const real* frameData(const FeatureVector& point) { return point.data(); }
+
+      void setFrames(Sequence& point, const real* frames,
+                     unsigned int dim, unsigned int length) {
+        point.setFrames(Eigen::Map<const Matrix>(frames, dim, length));
+      }
+
+      void setFrames(FeatureVector& point, const real* frames,
+                     unsigned int dim, unsigned int length) {
+        point = Eigen::Map<const Vector>(frames, dim);
+      }
+    }
+
+    DataSetCache::DataSetCache(const std::string& directory)
+      : directory_(directory) {}
+
+    std::unique_ptr<DataSetCache> DataSetCache::fromEnvironment() {
+      const char* directory = std::getenv("TRACK_SELECT_CACHE");
+      if (!directory || !*directory) return std::unique_ptr<DataSetCache>();
+      return std::unique_ptr<DataSetCache>(new DataSetCache(directory));
+    }
+
+    const std::string& DataSetCache::directory() const {
+      return directory_;
+    }
+
+    std::string DataSetCache::path(database_id id) const {
+      std::stringstream ss;
+      ss << directory_ << "/" << Prefix << id << Suffix;
+      return ss.str();
+    }
+
+    template <class data_point>
+    bool DataSetCache::load(database_id id, const std::string& stamp,
+                            DataSet<data_point>& set) const {
+      int fd = open(path(id).c_str(), O_RDONLY);
+      if (fd < 0) return false;
+
+      struct stat info;
+      if (fstat(fd, &info) || (size_t)info.st_size < sizeof(Header)) {
+        close(fd);
+        throw ErrorDataSetCache("DataSetCache: cannot read " + path(id));
+      }
+
+      Mapping mapping(fd, info.st_size);
+
+      Reader reader(mapping.data(), info.st_size);
+      const Header& header = *reader.column<Header>(1);
+      if (std::memcmp(header.magic, Magic, sizeof(Magic)))
+        throw ErrorDataSetCache("DataSetCache: not a cache file " + path(id));
+
+      if (header.version != Version || header.real_size != sizeof(real) ||
+          header.id != id || header.point_type != pointType((data_point*)0))
+        return false;
+
+      const std::uint64_t* offsets = reader.column<std::uint64_t>(header.points + 1);
+      const std::uint64_t* ids = reader.column<std::uint64_t>(header.points);
+      const std::uint32_t* categories = reader.column<std::uint32_t>(header.points);
+      const std::uint32_t* track_ids = reader.column<std::uint32_t>(header.points);
+      const std::uint32_t* source_data_sets = reader.column<std::uint32_t>(header.points);
+      const std::uint32_t* flags = reader.column<std::uint32_t>(header.points);
+      const real* ranges = reader.column<real>(2 * header.points);
+      const real* frames = reader.column<real>(header.columns * header.dim);
+
+      if (reader.string() != stamp) return false;
+      std::vector<std::string> names = reader.strings();
+
+      /* The file numbers its names itself, they are interned once here */
+      std::vector<StringInterner::id_type> name_ids;
+      name_ids.reserve(names.size());
+      for (auto& name : names)
+        name_ids.push_back(StringInterner::sourceDataSets().intern(name));
+
+      if (header.points && offsets[header.points] != header.columns)
+        throw ErrorDataSetCache("DataSetCache: inconsistent offsets in " + path(id));
+
+      std::lock_guard<std::mutex> lock(set.lock_);
+      if (header.dim_set && !set.dimSet()) set.setDimUnsafe(header.dim);
+
+      set.data_points_.reserve(header.points);
+      for (std::uint64_t i = 0; i < header.points; i++) {
+        data_point point;
+        setFrames(point, frames + offsets[i] * header.dim, header.dim,
+                  offsets[i + 1] - offsets[i]);
+
+        if (ids[i]) point.setId(ids[i]);
+        if (categories[i] != NotSet) point.setCategory(categories[i]);
+        if (track_ids[i] != NotSet) point.setSourceTrackId(track_ids[i]);
+        if (source_data_sets[i] != NotSet) {
+          if (source_data_sets[i] >= names.size())
+            throw ErrorDataSetCache("DataSetCache: inconsistent source data "
+                                    "sets in " + path(id));
+          point.setSourceDataSetId(name_ids[source_data_sets[i]]);
+        }
+        if (flags[i] & RangeSet)
+          point.setSourceRange(msmm::CustomRange(ranges[2 * i], ranges[2 * i + 1]));
+
+        set.data_points_.push_back(std::move(point));
+        set.data_points_.back().setOwner(&set);
+      }
+
+      return true;
+    }
+
+    template <class data_point>
+    void DataSetCache::save(const DataSet<data_point>& set,
+                            const std::string& stamp) const {
+      mkdir(directory_.c_str(), 0755);
+
+      Header header;
+      std::memcpy(header.magic, Magic, sizeof(Magic));
+      header.version = Version;
+      header.real_size = sizeof(real);
+      header.id = set.id();
+      header.points = set.size();
+      header.dim_set = set.dimSet();
+      header.dim = set.dimSet() ? set.dim() : 0;
+      header.point_type = pointType((data_point*)0);
+      header.reserved = 0;
+
+      std::vector<std::uint64_t> offsets(1, 0);
+      std::vector<std::uint64_t> ids;
+      std::vector<std::uint32_t> categories;
+      std::vector<std::uint32_t> track_ids;
+      std::vector<std::uint32_t> source_data_sets;
+      std::vector<std::uint32_t> flags;
+      std::vector<real> ranges;
+      std::vector<std::string> names;
+      std::map<StringInterner::id_type, std::uint32_t> index;
+
+      for (auto& point : set) {
+        offsets.push_back(offsets.back() + frameCount(point));
+        ids.push_back(point.hasId() ? point.id() : 0);
+        categories.push_back(point.categorySet() ? point.category() : NotSet);
+        track_ids.push_back(point.sourceTrackIdSet() ? point.sourceTrackId() : NotSet);
+
+        if (point.sourceDataSetSet()) {
+          auto it = index.find(point.sourceDataSetId());
+          if (it == index.end()) {
+            it = index.insert(std::make_pair(point.sourceDataSetId(),
+                                             (std::uint32_t)names.size())).first;
+            names.push_back(point.sourceDataSet());
+          }
+          source_data_sets.push_back(it->second);
+        } else {
+          source_data_sets.push_back(NotSet);
+        }
+
+        flags.push_back(point.sourceRangeSet() ? RangeSet : 0);
+        ranges.push_back(point.sourceRangeSet() ? point.sourceRange().low() : 0);
+        ranges.push_back(point.sourceRangeSet() ? point.sourceRange().high() : 0);
+      }
+      header.columns = offsets.back();
+
+      std::stringstream aside;
+      aside << path(set.id()) << ".tmp." << getpid() << "." << aside_count++;
+
+      try {
+        Writer out(aside.str());
+        out.write(&header, sizeof(header));
+        out.write(offsets);
+        out.write(ids);
+        out.write(categories);
+        out.write(track_ids);
+        out.write(source_data_sets);
+        out.write(flags);
+        out.write(ranges);
+
+        /* The frames of the points one after the other in a single block */
+        for (auto& point : set)
+          out.append(frameData(point),
+                     (size_t)frameCount(point) * header.dim * sizeof(real));
+        out.pad();
+
+        out.write(stamp);
+        out.write(names);
+        out.close();
+      } catch (...) {
+        std::remove(aside.str().c_str());
+        throw;
+      }
+
+      if (std::rename(aside.str().c_str(), path(set.id()).c_str())) {
+        std::remove(aside.str().c_str());
+        throw ErrorDataSetCache("DataSetCache: cannot write " + path(set.id()));
+      }
+    }
+
+    void DataSetCache::invalidate(database_id id) const {
+      std::remove(path(id).c_str());
+    }
+
+    void DataSetCache::purge() const {
+      for (database_id id : entries()) invalidate(id);
+    }
+
+    std::vector<database_id> DataSetCache::entries() const {
+      std::vector<database_id> ids;
+
+      DIR* dir = opendir(directory_.c_str());
+      if (!dir) return ids;
+
+      for (struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+        std::string name(entry->d_name);
+        size_t prefix = sizeof(Prefix) - 1;
+        size_t suffix = sizeof(Suffix) - 1;
+        if (name.size() <= prefix + suffix ||
+            name.compare(0, prefix, Prefix) ||
+            name.compare(name.size() - suffix, suffix, Suffix))
+          continue;
+
+        std::stringstream ss(name.substr(prefix, name.size() - prefix - suffix));
+        database_id id;
+        if (ss >> id && ss.eof()) ids.push_back(id);
+      }
+      closedir(dir);
+
+      return ids;
+    }
+
+    template bool DataSetCache::load(database_id, const std::string&,
+                                     DataSet<Sequence>&) const;
+    template bool DataSetCache::load(database_id, const std::string&,
+                                     DataSet<FeatureVector>&) const;
+    template void DataSetCache::save(const DataSet<Sequence>&,
+                                     const std::string&) const;
+    template void DataSetCache::save(const DataSet<FeatureVector>&,
+                                     const std::string&) const;
+  }
+}
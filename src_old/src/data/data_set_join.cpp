@@ -0,0 +1,127 @@
+#include "data/data_set_join.hpp"
+
+#include <functional>
+#include <limits>
+
+namespace track_select {
+  namespace data {
+
+    bool JoinKey::operator==(const JoinKey& obj) const {
+      return source_data_set == obj.source_data_set &&
+        source_track_id == obj.source_track_id &&
+        range_low == obj.range_low &&
+        range_high == obj.range_high;
+    }
+
+    size_t JoinKeyHash::operator()(const JoinKey& key) const {
+      size_t h = std::hash<unsigned int>()(key.source_data_set);
+      h ^= std::hash<unsigned int>()(key.source_track_id) + 0x9e3779b9 +
+        (h << 6) + (h >> 2);
+      h ^= std::hash<real>()(key.range_low) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      h ^= std::hash<real>()(key.range_high) + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
+    }
+
+    template <class data_point>
+    const unsigned int JoinIndex<data_point>::NoMatch =
+      std::numeric_limits<unsigned int>::max();
+
+    template <class data_point>
+    JoinIndex<data_point>::JoinIndex(const DataSetView<data_point>& points,
+                                     bool match_range)
+      : points_(points),
+        match_range_(match_range),
+        next_(points.size(), NoMatch) {
+      first_.reserve(points_.size());
+
+      /* Inserted from the back so each chain is in the order of the view */
+      JoinKey k;
+      for (unsigned int i = points_.size(); i-- > 0; ) {
+        if (!key(points_[i], match_range_, k)) continue;
+
+        auto it = first_.insert(std::make_pair(k, i));
+        if (!it.second) {
+          next_[i] = it.first->second;
+          it.first->second = i;
+        }
+      }
+    }
+
+    template <class data_point>
+    bool JoinIndex<data_point>::key(const DataPoint& point, bool match_range,
+                                    JoinKey& key) {
+      if (!point.sourceDataSetSet() || !point.sourceTrackIdSet())
+        return false;
+      if (match_range && !point.sourceRangeSet())
+        return false;
+
+      key.source_data_set = point.sourceDataSetId();
+      key.source_track_id = point.sourceTrackId();
+      key.range_low = match_range ? point.sourceRange().low() : 0;
+      key.range_high = match_range ? point.sourceRange().high() : 0;
+      return true;
+    }
+
+    template <class data_point>
+    const DataSetView<data_point>& JoinIndex<data_point>::points() const {
+      return points_;
+    }
+
+    template <class data_point>
+    bool JoinIndex<data_point>::matchRange() const {
+      return match_range_;
+    }
+
+    template <class data_point> template <class probe_point>
+    std::pair<DataSetView<probe_point>, DataSetView<data_point>>
+    JoinIndex<data_point>::join(const DataSetView<probe_point>& probe) const {
+      /* The first match of every probe point, then the number of matches
+       * before it, so the pairs are written in parallel without locking */
+      std::vector<unsigned int> first(probe.size(), NoMatch);
+      std::vector<unsigned int> offsets(probe.size() + 1, 0);
+
+#pragma omp parallel for schedule(dynamic, 256)
+      for (unsigned int i = 0; i < probe.size(); i++) {
+        JoinKey k;
+        if (!key(probe[i], match_range_, k)) continue;
+
+        auto it = first_.find(k);
+        if (it == first_.end()) continue;
+
+        first[i] = it->second;
+        for (unsigned int j = it->second; j != NoMatch; j = next_[j])
+          offsets[i + 1]++;
+      }
+
+      for (unsigned int i = 0; i < probe.size(); i++)
+        offsets[i + 1] += offsets[i];
+
+      typename DataSetView<probe_point>::index_container left(offsets.back());
+      typename DataSetView<data_point>::index_container right(offsets.back());
+
+#pragma omp parallel for schedule(dynamic, 256)
+      for (unsigned int i = 0; i < probe.size(); i++) {
+        unsigned int pos = offsets[i];
+        for (unsigned int j = first[i]; j != NoMatch; j = next_[j]) {
+          left[pos] = i;
+          right[pos] = j;
+          pos++;
+        }
+      }
+
+      return std::make_pair(probe.select(left), points_.select(right));
+    }
+
+    template class JoinIndex<Sequence>;
+    template class JoinIndex<FeatureVector>;
+
+    template std::pair<SequenceSetView, SequenceSetView>
+    JoinIndex<Sequence>::join(const SequenceSetView&) const;
+    template std::pair<FeatureVectorSetView, SequenceSetView>
+    JoinIndex<Sequence>::join(const FeatureVectorSetView&) const;
+    template std::pair<SequenceSetView, FeatureVectorSetView>
+    JoinIndex<FeatureVector>::join(const SequenceSetView&) const;
+    template std::pair<FeatureVectorSetView, FeatureVectorSetView>
+    JoinIndex<FeatureVector>::join(const FeatureVectorSetView&) const;
+  }
+}
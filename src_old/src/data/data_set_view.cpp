@@ -0,0 +1,140 @@
+#include "data/data_set_view.hpp"
+
+namespace track_select {
+  namespace data {
+
+    template <class data_point>
+    DataSetView<data_point>::DataSetView(
+      const std::shared_ptr<const DataSet<data_point>>& set,
+      index_container&& index)
+      : set_(set), index_(std::move(index)) {}
+
+    template <class data_point>
+    DataSetView<data_point>::DataSetView(
+      const std::shared_ptr<const DataSet<data_point>>& set)
+      : set_(set), index_(set->size()) {
+      for (unsigned int i = 0; i < index_.size(); i++)
+        index_[i] = i;
+    }
+
+    template <class data_point>
+    DataSetView<data_point>::DataSetView(const DataSet<data_point>& set)
+      : DataSetView(std::shared_ptr<const DataSet<data_point>>(
+                      std::shared_ptr<const DataSet<data_point>>(), &set)) {}
+
+    template <class data_point>
+    unsigned int DataSetView<data_point>::size() const {
+      return index_.size();
+    }
+
+    template <class data_point>
+    unsigned int DataSetView<data_point>::dim() const {
+      return set_->dim();
+    }
+
+    template <class data_point>
+    const data_point& DataSetView<data_point>::operator[](unsigned int i) const {
+      return (*set_)[index_[i]];
+    }
+
+    template <class data_point>
+    typename DataSetView<data_point>::const_iterator
+    DataSetView<data_point>::begin() const {
+      return const_iterator(set_->begin(), index_.begin());
+    }
+
+    template <class data_point>
+    typename DataSetView<data_point>::const_iterator
+    DataSetView<data_point>::end() const {
+      return const_iterator(set_->begin(), index_.end());
+    }
+
+    template <class data_point>
+    const DataSet<data_point>& DataSetView<data_point>::set() const {
+      return *set_;
+    }
+
+    template <class data_point>
+    const typename DataSetView<data_point>::index_container&
+    DataSetView<data_point>::indexes() const {
+      return index_;
+    }
+
+    template <class data_point>
+    DataSetView<data_point>
+    DataSetView<data_point>::subset(unsigned int begin, unsigned int end) const {
+      return DataSetView<data_point>(set_,
+                                     index_container(index_.begin() + begin,
+                                                     index_.begin() + end));
+    }
+
+    template <class data_point>
+    DataSetView<data_point>
+    DataSetView<data_point>::select(const index_container& positions) const {
+      index_container index;
+      index.reserve(positions.size());
+      for (unsigned int p : positions)
+        index.push_back(index_[p]);
+
+      return DataSetView<data_point>(set_, std::move(index));
+    }
+
+    template <class data_point>
+    DataSetView<data_point>
+    DataSetView<data_point>::category(unsigned short category) const {
+      index_container index;
+      for (unsigned int i : index_)
+        if ((*set_)[i].category() == category)
+          index.push_back(i);
+
+      return DataSetView<data_point>(set_, std::move(index));
+    }
+
+    template <class data_point>
+    std::pair<DataSetView<data_point>, DataSetView<data_point>>
+    DataSetView<data_point>::fold(unsigned int k, unsigned int folds) const {
+      unsigned int begin = index_.size() * k / folds;
+      unsigned int end = index_.size() * (k + 1) / folds;
+
+      index_container train;
+      train.reserve(index_.size() - (end - begin));
+      train.insert(train.end(), index_.begin(), index_.begin() + begin);
+      train.insert(train.end(), index_.begin() + end, index_.end());
+
+      return std::make_pair(DataSetView<data_point>(set_, std::move(train)),
+                            subset(begin, end));
+    }
+
+    template <class data_point>
+    DataSet<data_point> DataSetView<data_point>::copy() const {
+      DataSet<data_point> copy;
+      if (set_->infoSet()) copy.setInfo(set_->info());
+      if (set_->frameInfoSet()) copy.setFrameInfo(set_->frameInfo());
+
+      DataSetBuilder<data_point> builder;
+      builder.reserve(size());
+      for (unsigned int i : index_)
+        builder << (*set_)[i];
+
+      copy.merge(builder);
+      return copy;
+    }
+
+    template <class data_point>
+    void DataSetView<data_point>::zero_class_check(
+      const DataSetView<data_point>& view) {
+      unsigned int y = 0;
+      unsigned int n = 0;
+      for (auto& point : view)
+        if (point.category())
+          y++;
+        else
+          n++;
+      if (!y) throw ErrorNullClass();
+      if (!n) throw ErrorNullClass();
+    }
+
+    template class DataSetView<Sequence>;
+    template class DataSetView<FeatureVector>;
+  }
+}
@@ -1,4 +1,5 @@
 #include "data/feature_vector.hpp"
+#include "data/stored_data.hpp"
 
 
 namespace track_select {
@@ -55,14 +56,8 @@ namespace track_select {
       Vector::resize(d, 1);
     }
 
-    pqxx::binarystring FeatureVector::data() const {
-      track_select::real * raw_data = new track_select::real[dim()];
-      for (unsigned int i = 0; i < dim(); i++)
-        raw_data[i] = (*this)(i);
-
-      pqxx::binarystring res(raw_data, dim()*sizeof(track_select::real));
-      delete[] raw_data;
-      return res;
+    const track_select::real* FeatureVector::values() const {
+      return Vector::data();
     }
 
 
@@ -70,21 +65,14 @@ namespace track_select {
       : Vector(data_point["frame_dim"].as<unsigned int>()),
         DataPoint(data_point) {
 
-      unsigned int data_size = data_point["data_type_size"].as<unsigned int>();
-      if (data_size == sizeof(float))
-        load<float>(data_point);
-      else if (data_size == sizeof(double))
-        load<double>(data_point);
-      else if (data_size ==  sizeof(long double))
-        load<long double>(data_point);
-      else {
+      StoredData stored(data_point);
+      if (stored.cols() != 1) {
         std::stringstream ss;
-        ss << "Unknown data size "
-           << data_point["data_type_size"].as<unsigned int>()
-           << " : " << data_size << " : " << sizeof(long double);
-        throw ErrorInconsistentDataType(ss.str());
+        ss << "FeatureVector: track length should be 1 however it is "
+           << stored.cols();
+        throw ErrorInconsistentDim(ss.str());
       }
-
+      stored.convert((Vector&)*this);
     }
 
 
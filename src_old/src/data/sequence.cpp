@@ -1,17 +1,30 @@
 #include "data/sequence.hpp"
+#include "data/stored_data.hpp"
+
+#include <algorithm>
 
 namespace track_select {
 
   namespace data {
 
-    Sequence::Sequence() {};
+    Sequence::Sequence() : length_(0) {};
 
     Sequence::Sequence(unsigned int d)
-      : DataPoint(d) {}
+      : DataPoint(d),
+        frames_(d, 0),
+        length_(0) {}
 
     Sequence::Sequence(const Sequence& seq)
       : DataPoint((const DataPoint&)seq),
-        eigen_data_(seq.eigen_data_) {
+        frames_(seq.matrix()),
+        length_(seq.length_) {
+    }
+
+    Sequence::Sequence(Sequence&& seq)
+      : DataPoint((const DataPoint&)seq),
+        frames_(std::move(seq.frames_)),
+        length_(seq.length_) {
+      seq.length_ = 0;
     }
 
     Sequence::~Sequence() {}
@@ -19,7 +32,17 @@ namespace track_select {
 
     Sequence& Sequence::operator=(const Sequence& obj) {
       DataPoint::operator=((const DataPoint&)obj);
-      eigen_data_ = obj.eigen_data_;
+      frames_ = obj.matrix();
+      length_ = obj.length_;
+
+      return *this;
+    }
+
+    Sequence& Sequence::operator=(Sequence&& obj) {
+      DataPoint::operator=((const DataPoint&)obj);
+      frames_ = std::move(obj.frames_);
+      length_ = obj.length_;
+      obj.length_ = 0;
 
       return *this;
     }
@@ -28,15 +51,30 @@ namespace track_select {
 
       if (!DataPoint::operator==((const DataPoint&)rs))
         return false;
-      if (eigen_data_ != rs.eigen_data_)
+      if (length_ != rs.length_)
+        return false;
+      if (length_ && matrix() != rs.matrix())
         return false;
 
       return true;
     }
 
 
-    const Vector& Sequence::operator[](unsigned int i) const {
-      return eigen_data_[i];
+    Sequence::const_frame Sequence::operator[](unsigned int i) const {
+      return const_frame(frames_.data() + (size_t)i * frames_.rows(), frames_.rows());
+    }
+
+    Sequence::frame Sequence::operator[](unsigned int i) {
+      return frame(frames_.data() + (size_t)i * frames_.rows(), frames_.rows());
+    }
+
+    Eigen::Map<const Matrix> Sequence::matrix() const {
+      return Eigen::Map<const Matrix>(frames_.data(), frames_.rows(), length_);
+    }
+
+    void Sequence::reserve(unsigned int size) {
+      if (size <= frames_.cols()) return;
+      frames_.conservativeResize(dim(), size);
     }
 
 
@@ -49,42 +87,42 @@ namespace track_select {
         throw ErrorInconsistentDim(ss.str());
       }
 
-      eigen_data_.push_back(frame);
+      if (frames_.rows() != frame.rows())
+        frames_.resize(frame.rows(), frames_.cols());
+
+      /* Grow geometrically so appending is amortised constant time */
+      if (length_ == frames_.cols())
+        reserve(std::max(4u, 2 * length_));
+
+      frames_.col(length_++) = frame;
       return *this;
     }
 
-    pqxx::binarystring Sequence::data() const {
-      real* raw_data = new real[size()*dim()];
-
-      unsigned int index = 0;
-      for (auto& frame : *this)
-        for (unsigned int i = 0; i < frame.rows(); i++)
-          raw_data[index++] = frame(i);
+    void Sequence::setFrames(const Eigen::Map<const Matrix>& frames) {
+      if (!dimSet()) setDim(frames.rows());
+      if (frames.rows() != dim()) {
+        std::stringstream ss;
+        ss << "Sequence: frame dim should be " << dim()
+           << " however it is " << frames.rows();
+        throw ErrorInconsistentDim(ss.str());
+      }
 
+      frames_ = frames;
+      length_ = frames.cols();
+    }
 
-      pqxx::binarystring res(raw_data, size()*dim()*sizeof(real));
-      delete [] raw_data;
-      return res;
+    const real* Sequence::values() const {
+      /* The frames are stored one after the other as in the data column */
+      return frames_.data();
     }
 
     Sequence::Sequence(const pqxx::tuple& data_point)
-      : DataPoint(data_point) {
-
-      unsigned int data_size = data_point["data_type_size"].as<unsigned int>();
-
-      if (data_size == sizeof(float))
-        load<float>(data_point);
-      else if (data_size == sizeof(double))
-        load<double>(data_point);
-      else if (data_size == sizeof(long double))
-        load<long double>(data_point);
-      else {
-        std::stringstream ss;
-        ss << "Unknown data size "
-           << data_point["data_type_size"].as<unsigned int>();
-        throw ErrorInconsistentDataType(ss.str());
-      }
+      : DataPoint(data_point),
+        length_(0) {
 
+      StoredData stored(data_point);
+      stored.convert(frames_);
+      length_ = stored.cols();
     }
 
 
@@ -102,24 +140,26 @@ namespace track_select {
 
 
     unsigned int Sequence::size() const {
-      return eigen_data_.size();
+      return length_;
     }
 
 
     Sequence::const_iterator Sequence::begin() const {
-      return eigen_data_.begin();
+      return const_iterator(frames_.data(), frames_.rows());
     }
 
     Sequence::const_iterator Sequence::end() const {
-      return eigen_data_.end();
+      return const_iterator(frames_.data() + (size_t)length_ * frames_.rows(),
+                            frames_.rows());
     }
 
     Sequence::iterator Sequence::begin() {
-      return eigen_data_.begin();
+      return iterator(frames_.data(), frames_.rows());
     }
 
     Sequence::iterator Sequence::end() {
-      return eigen_data_.end();
+      return iterator(frames_.data() + (size_t)length_ * frames_.rows(),
+                      frames_.rows());
     }
 
     std::ostream& operator<<(std::ostream& out, const Sequence& s) {
@@ -0,0 +1,218 @@
+#include "data/sequence_arena.hpp"
+
+#include <sstream>
+
+namespace track_select {
+  namespace data {
+    const unsigned short SequenceArena::NoCategory =
+      std::numeric_limits<unsigned short>::max();
+    const unsigned int SequenceArena::NoTrackId =
+      std::numeric_limits<unsigned int>::max();
+    const unsigned int SequenceArena::NoSourceDataSet =
+      std::numeric_limits<unsigned int>::max();
+
+    SequenceArena::SequenceArena() : dim_(0), offsets_(1, 0) {}
+
+    SequenceArena::SequenceArena(const SequenceSet& set)
+      : dim_(set.dimSet() ? set.dim() : 0),
+        offsets_(1, 0) {
+      pack(set.begin(), set.end());
+    }
+
+    SequenceArena::SequenceArena(const SequenceSetView& view)
+      : dim_(view.set().dimSet() ? view.dim() : 0),
+        offsets_(1, 0) {
+      pack(view.begin(), view.end());
+    }
+
+    template <class sequence_iterator>
+    void SequenceArena::pack(sequence_iterator begin, sequence_iterator end) {
+      unsigned int size = end - begin;
+
+      offsets_.reserve(size + 1);
+      for (auto it = begin; it != end; it++)
+        offsets_.push_back(offsets_.back() + it->size());
+
+      frames_.resize(dim_, offsets_.back());
+
+      ids_.reserve(size);
+      categories_.reserve(size);
+      source_track_ids_.reserve(size);
+      source_data_sets_.reserve(size);
+
+      std::map<std::string, unsigned int> index;
+
+      unsigned int i = 0;
+      for (auto it = begin; it != end; it++) {
+        const Sequence& seq = *it;
+        if (seq.size())
+          frames_.middleCols(offsets_[i], seq.size()) = seq.matrix();
+
+        ids_.push_back(seq.hasId() ? seq.id() : 0);
+        categories_.push_back(seq.categorySet() ? seq.category() : NoCategory);
+        source_track_ids_.push_back(seq.sourceTrackIdSet() ?
+                                    seq.sourceTrackId() : NoTrackId);
+        source_data_sets_.push_back(seq.sourceDataSetSet() ?
+                                    intern(seq.sourceDataSet(), index) :
+                                    NoSourceDataSet);
+        i++;
+      }
+    }
+
+    SequenceArena::SequenceArena(const std::vector<SequenceArena>& parts)
+      : dim_(0), offsets_(1, 0) {
+
+      unsigned int sequences = 0;
+      unsigned int columns = 0;
+      for (auto& part : parts) {
+        if (!part.size()) continue;
+        if (!dim_) dim_ = part.dim_;
+        if (part.dim_ != dim_) {
+          std::stringstream ss;
+          ss << "SequenceArena: data dim should be " << dim_
+             << " however it is " << part.dim_;
+          throw ErrorInconsistentDim(ss.str());
+        }
+        sequences += part.size();
+        columns += part.frames_.cols();
+      }
+
+      frames_.resize(dim_, columns);
+      offsets_.reserve(sequences + 1);
+      ids_.reserve(sequences);
+      categories_.reserve(sequences);
+      source_track_ids_.reserve(sequences);
+      source_data_sets_.reserve(sequences);
+
+      std::map<std::string, unsigned int> index;
+
+      for (auto& part : parts) {
+        if (!part.size()) continue;
+
+        unsigned int first = offsets_.back();
+        if (part.frames_.cols())
+          frames_.middleCols(first, part.frames_.cols()) = part.frames_;
+        for (unsigned int i = 1; i < part.offsets_.size(); i++)
+          offsets_.push_back(first + part.offsets_[i]);
+
+        ids_.insert(ids_.end(), part.ids_.begin(), part.ids_.end());
+        categories_.insert(categories_.end(),
+                           part.categories_.begin(), part.categories_.end());
+        source_track_ids_.insert(source_track_ids_.end(),
+                                 part.source_track_ids_.begin(),
+                                 part.source_track_ids_.end());
+
+        std::vector<unsigned int> names;
+        for (auto& name : part.source_data_set_names_)
+          names.push_back(intern(name, index));
+        for (unsigned int source : part.source_data_sets_)
+          source_data_sets_.push_back(source == NoSourceDataSet ?
+                                      NoSourceDataSet : names[source]);
+      }
+    }
+
+    unsigned int
+    SequenceArena::intern(const std::string& source_data_set,
+                          std::map<std::string, unsigned int>& index) {
+      auto it = index.find(source_data_set);
+      if (it != index.end()) return it->second;
+
+      source_data_set_names_.push_back(source_data_set);
+      index[source_data_set] = source_data_set_names_.size() - 1;
+      return source_data_set_names_.size() - 1;
+    }
+
+    unsigned int SequenceArena::size() const {
+      return offsets_.size() - 1;
+    }
+
+    unsigned int SequenceArena::dim() const {
+      return dim_;
+    }
+
+    const Matrix& SequenceArena::frames() const {
+      return frames_;
+    }
+
+    const std::vector<unsigned int>& SequenceArena::offsets() const {
+      return offsets_;
+    }
+
+    unsigned int SequenceArena::length(unsigned int i) const {
+      return offsets_[i + 1] - offsets_[i];
+    }
+
+    Eigen::Map<const Matrix> SequenceArena::sequence(unsigned int i) const {
+      return Eigen::Map<const Matrix>(frames_.data() + (size_t)offsets_[i] * dim_,
+                                      dim_, length(i));
+    }
+
+    Sequence::const_iterator SequenceArena::begin(unsigned int i) const {
+      return Sequence::const_iterator(frames_.data() + (size_t)offsets_[i] * dim_,
+                                      dim_);
+    }
+
+    Sequence::const_iterator SequenceArena::end(unsigned int i) const {
+      return Sequence::const_iterator(frames_.data() + (size_t)offsets_[i + 1] * dim_,
+                                      dim_);
+    }
+
+    database_id SequenceArena::id(unsigned int i) const {
+      return ids_[i];
+    }
+
+    unsigned short SequenceArena::category(unsigned int i) const {
+      if (categories_[i] == NoCategory)
+        throw ErrorAttributeNotSet("SequenceArena::category");
+      return categories_[i];
+    }
+
+    unsigned int SequenceArena::sourceTrackId(unsigned int i) const {
+      if (source_track_ids_[i] == NoTrackId)
+        throw ErrorAttributeNotSet("SequenceArena::sourceTrackId");
+      return source_track_ids_[i];
+    }
+
+    unsigned int SequenceArena::sourceDataSetIndex(unsigned int i) const {
+      return source_data_sets_[i];
+    }
+
+    const std::string& SequenceArena::sourceDataSet(unsigned int i) const {
+      if (source_data_sets_[i] == NoSourceDataSet)
+        throw ErrorAttributeNotSet("SequenceArena::sourceDataSet");
+      return source_data_set_names_[source_data_sets_[i]];
+    }
+
+    const std::vector<unsigned short>& SequenceArena::categories() const {
+      return categories_;
+    }
+
+    const std::vector<unsigned int>& SequenceArena::sourceTrackIds() const {
+      return source_track_ids_;
+    }
+
+    const std::vector<unsigned int>& SequenceArena::sourceDataSetIndexes() const {
+      return source_data_sets_;
+    }
+
+    const std::vector<std::string>& SequenceArena::sourceDataSets() const {
+      return source_data_set_names_;
+    }
+
+    Sequence SequenceArena::at(unsigned int i) const {
+      Sequence seq(dim_);
+      seq.reserve(length(i));
+      for (auto it = begin(i); it != end(i); it++)
+        seq << *it;
+
+      if (ids_[i]) seq.setId(ids_[i]);
+      if (categories_[i] != NoCategory) seq.setCategory(categories_[i]);
+      if (source_track_ids_[i] != NoTrackId)
+        seq.setSourceTrackId(source_track_ids_[i]);
+      if (source_data_sets_[i] != NoSourceDataSet)
+        seq.setSourceDataSet(sourceDataSet(i));
+      return seq;
+    }
+
+  }
+}
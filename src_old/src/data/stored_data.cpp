@@ -0,0 +1,37 @@
+#include "data/stored_data.hpp"
+
+namespace track_select {
+  namespace data {
+
+    StoredData::StoredData(const pqxx::tuple& data_point)
+      : data_(data_point["data"]),
+        rows_(data_point["frame_dim"].as<unsigned int>()),
+        cols_(data_point["track_length"].as<unsigned int>()),
+        type_size_(data_point["data_type_size"].as<unsigned int>()) {
+
+      if (data_.size() < (size_t)rows_ * cols_ * type_size_) {
+        std::stringstream ss;
+        ss << "StoredData: data of " << data_.size() << " bytes is shorter "
+           << "than " << cols_ << " frames of dim " << rows_;
+        throw ErrorInconsistentDim(ss.str());
+      }
+    }
+
+    unsigned int StoredData::rows() const {
+      return rows_;
+    }
+
+    unsigned int StoredData::cols() const {
+      return cols_;
+    }
+
+    unsigned int StoredData::typeSize() const {
+      return type_size_;
+    }
+
+    StoredData::float_frames StoredData::floats() const {
+      return as<float>();
+    }
+
+  }
+}
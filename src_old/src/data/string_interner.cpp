@@ -0,0 +1,73 @@
+#include "data/string_interner.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <track-select>
+
+namespace track_select {
+  namespace data {
+
+    static std::atomic<unsigned long> generations(0);
+
+    StringInterner::StringInterner() : size_(0), generation_(++generations) {
+      for (unsigned int c = 0; c < MaxChunks; c++) chunks_[c] = 0;
+    }
+
+    StringInterner::~StringInterner() {
+      for (unsigned int c = 0; c < MaxChunks; c++) delete[] chunks_[c].load();
+    }
+
+    StringInterner::id_type StringInterner::intern(const std::string& str) {
+      /* Points are mostly read one source after the other, so the last
+       * string of the thread is usually the one asked for again */
+      thread_local unsigned long last_table = 0;
+      thread_local std::string last_str;
+      thread_local id_type last_id = 0;
+      if (last_table == generation_ && last_str == str) return last_id;
+
+      std::lock_guard<std::mutex> lock(lock_);
+
+      auto it = index_.find(str);
+      if (it == index_.end()) {
+        id_type id = size_.load(std::memory_order_relaxed);
+        if (id >= ChunkSize * MaxChunks)
+          throw std::length_error("StringInterner: too many strings");
+
+        unsigned int chunk = id / ChunkSize;
+        if (!chunks_[chunk].load(std::memory_order_relaxed))
+          chunks_[chunk].store(new std::string[ChunkSize],
+                               std::memory_order_release);
+
+        chunks_[chunk].load(std::memory_order_relaxed)[id % ChunkSize] = str;
+        size_.store(id + 1, std::memory_order_release);
+        it = index_.insert(std::make_pair(str, id)).first;
+      }
+
+      last_table = generation_;
+      last_str = str;
+      last_id = it->second;
+      return it->second;
+    }
+
+    const std::string& StringInterner::str(id_type id) const {
+      if (id >= size_.load(std::memory_order_acquire)) {
+        std::stringstream ss;
+        ss << "StringInterner: no string with id " << id;
+        throw std::out_of_range(ss.str());
+      }
+
+      return chunks_[id / ChunkSize].load(std::memory_order_acquire)
+        [id % ChunkSize];
+    }
+
+    unsigned int StringInterner::size() const {
+      return size_.load(std::memory_order_acquire);
+    }
+
+    StringInterner& StringInterner::sourceDataSets() {
+      static StringInterner table;
+      return table;
+    }
+
+  }
+}
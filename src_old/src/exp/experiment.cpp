@@ -1,4 +1,5 @@
 #include "exp/experiment.hpp"
+#include "data/bulk_insert.hpp"
 
 namespace track_select {
   namespace exp {
@@ -62,7 +63,8 @@ namespace track_select {
      *  to samples.
      */
     Experiment::Experiment(unsigned int samples)
-      : samples_(samples) {
+      : samples_(samples),
+        thread_pool_(&parallel::ThreadPool::global()) {
       logs_ = experimentLog(samples);
     }
 
@@ -70,17 +72,22 @@ namespace track_select {
 
     Experiment&
     Experiment::run(void (*exp)(Experiment*, unsigned int, std::mutex&)) {
-      std::vector<std::thread> threads;
+      threadPool().parallelFor(0, samples(), 1, [&](unsigned int i) {
+          exp(this, i, run_mutex_);
+        });
 
-      for (unsigned int i = 0; i <  samples(); i++)
-        threads.push_back(std::thread(exp, this, i, std::ref(run_mutex_)));
-
-      for (auto& t : threads)
-        t.join();
+      return *this;
+    }
 
+    Experiment& Experiment::setThreadPool(parallel::ThreadPool& pool) {
+      thread_pool_ = &pool;
       return *this;
     }
 
+    parallel::ThreadPool& Experiment::threadPool() const {
+      return *thread_pool_;
+    }
+
     database_id Experiment::store(pqxx::work& work) const {
 
 
@@ -89,33 +96,6 @@ namespace track_select {
 (id, info, finger_print, created_at) \
 values( $1, $2, $3, now())");
 
-      work.conn().prepare("insert_property",
-                          "insert into experiment_property \
-(id, k, val, experiment_id) \
-values( $1, $2, $3, $4)");
-
-      work.conn().prepare("insert_result",
-                          "insert into experiment_result \
-(id, k, val, sample_id, experiment_id) \
-values( $1, $2, $3, $4, $5)");
-
-      work.conn().prepare("insert_plot",
-                          "insert into experiment_plot \
-(id, k, val, sample_id, experiment_id) \
-values( $1, $2, $3, $4, $5)");
-
-      work.conn().prepare("insert_log",
-                          "insert into experiment_log \
-(id, k, val, sample_id, data_size, data_type_size, experiment_id) \
-values( $1, $2, $3, $4, $5, $6, $7 )");
-
-      work.conn().prepare("insert_sequence_set",
-                          "insert into experiment_sequence_set \
-(id, k, experiment_id, sequence_set_id) \
-values( $1, $2, $3, $4)");
-
-
-
       database_id db_id = work
         .exec("select nextval('experiment_id_seq')")[0][0].as<database_id>();
 
@@ -124,81 +104,68 @@ values( $1, $2, $3, $4)");
         (info())
         (fingerPrint()).exec();
 
-
-      for (auto p : properties_) {
-        database_id pid = work
-          .exec("select nextval('experiment_property_id_seq')")[0][0]
-          .as<database_id>();
-        work.prepared("insert_property")
-          (pid)
+      /* The rows of the experiment are sent a few statements per table, their
+       * ids assigned by the database */
+      data::BulkInsert properties(work, "experiment_property",
+                                  {"k", "val", "experiment_id"});
+      for (auto p : properties_)
+        properties
           (p.first)
           (p.second)
-          (db_id).exec();
-      }
+          (db_id);
+      properties.flush();
 
-      for (auto p : results_) {
-        database_id rid = work.exec("select nextval('experiment_result_id_seq')")
-          [0][0].as<database_id>();
-        work.prepared("insert_result")
-          (rid)
+      data::BulkInsert results(work, "experiment_result",
+                               {"k", "val", "sample_id", "experiment_id"});
+      for (auto p : results_)
+        results
           (std::get<0>(p)) // Key
           (std::get<1>(p)) // Value
           (std::get<2>(p)) // ThreadId
-          (db_id).exec();
-      }
+          (db_id);
+      results.flush();
 
-      for (auto p : plots_) {
-        database_id pid = work.exec("select nextval('experiment_plot_id_seq')")
-          [0][0].as<database_id>();
-        work.prepared("insert_plot")
-          (pid)
+      data::BulkInsert plots(work, "experiment_plot",
+                             {"k", "val", "sample_id", "experiment_id"});
+      for (auto p : plots_)
+        plots
           (std::get<0>(p)) // Key
           (std::get<1>(p)) // Value
           (std::get<2>(p)) // ThreadId
-          (db_id).exec();
-      }
-
+          (db_id);
+      plots.flush();
 
+      data::BulkInsert logs(work, "experiment_log",
+                            {"k", "val", "sample_id", "data_size",
+                                "data_type_size", "experiment_id"});
       for (unsigned int i = 0; i < logs_.size(); i++) {
-        for (auto p : logs_[i]) {
-          database_id log_id = work.exec("select nextval('experiment_log_id_seq')")
-            [0][0].as<database_id>();
-
+        for (auto& p : logs_[i]) {
           unsigned int data_size = p.second.size();
-          real * data = new real[data_size];
+          pqxx::binarystring db_data((const void*)p.second.data(),
+                                     data_size*sizeof(real));
 
-          for (unsigned int i = 0; i < data_size; i++)
-            data[i] = p.second[i];
-
-          pqxx::binarystring db_data((void*)data, data_size*sizeof(real));
-
-          delete[] data;
-
-          work.prepared("insert_log")
-            (log_id)
+          logs
             (p.first) // Key
             (db_data) // Value
             (i) // sample id
             (data_size)
             (sizeof(real))
-            (db_id).exec();
+            (db_id);
         }
       }
+      logs.flush();
 
+      data::BulkInsert data_sets(work, "experiment_sequence_set",
+                                 {"k", "experiment_id", "sequence_set_id"});
       for (auto p : data_sets_) {
         if (!p.second->hasId())
           continue;
-        database_id rid
-          = work.exec("select nextval('experiment_sequence_set_id_seq')")
-          [0][0].as<database_id>();
-
-        work.prepared("insert_sequence_set")
-          (rid)
+        data_sets
           (p.first)
           (db_id)
-          (p.second->id()).exec();
-
+          (p.second->id());
       }
+      data_sets.flush();
 
       work.commit();
       return db_id;
@@ -14,6 +14,7 @@ namespace track_select {
         input_dim_(data_dim),
         categories_count_(categories),
         parallel_exec_(false),
+        thread_pool_(&parallel::ThreadPool::global()),
         generation_counter_(0) {}
 
     Classify::Classify(const Classify& obj)
@@ -22,6 +23,7 @@ namespace track_select {
         input_dim_(obj.input_dim_),
         categories_count_(obj.categories_count_),
         parallel_exec_(obj.parallel_exec_),
+        thread_pool_(obj.thread_pool_),
         generation_counter_(obj.generation_counter_) {}
 
     Classify& Classify::operator=(const Classify& obj) {
@@ -30,6 +32,7 @@ namespace track_select {
       input_dim_ = obj.input_dim_;
       categories_count_ = obj.categories_count_;
       parallel_exec_ = obj.parallel_exec_;
+      thread_pool_ = obj.thread_pool_;
       generation_counter_ = obj.generation_counter_;
 
       return *this;
@@ -49,12 +52,10 @@ namespace track_select {
       };
 
       if (parallelExec()) {
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < p_size; i++)
-          threads.push_back(std::thread(calc, i, std::ref(items[i])));
-
-        for (auto & t : threads)
-          t.join();
+        /* A member at a time, each one is a pass over the whole data set */
+        threadPool().parallelFor(0, p_size, 1, [&](unsigned int i) {
+            calc(i, items[i]);
+          });
       } else {
         for (unsigned int i = 0; i < p_size; i++)
           calc(i, items[i]);
@@ -66,14 +67,28 @@ namespace track_select {
     optimizer::OptimizerReportItem
     Classify::buildItem(const std::vector<std::tuple<unsigned short, Vector>>
                         &cls) const {
+      std::vector<unsigned short> categories;
+      Matrix probabilities(categoriesCount(), cls.size());
+      categories.reserve(cls.size());
+      for (unsigned int i = 0; i < cls.size(); i++) {
+        categories.push_back(std::get<0>(cls[i]));
+        probabilities.col(i) = std::get<1>(cls[i]);
+      }
+
+      return buildItem(categories, probabilities);
+    }
+
+    optimizer::OptimizerReportItem
+    Classify::buildItem(const std::vector<unsigned short>& categories,
+                        const Matrix& probabilities) const {
       optimizer::OptimizerReportItem item;
 
 
       Matrix confusion = Matrix::Zero(categoriesCount(), categoriesCount());
-      for (const auto& c : cls) {
+      for (unsigned int i = 0; i < categories.size(); i++) {
         Matrix::Index max_index;
-        std::get<1>(c).maxCoeff(&max_index);
-        confusion(std::get<0>(c), max_index)++;
+        probabilities.col(i).maxCoeff(&max_index);
+        confusion(categories[i], max_index)++;
       }
 
       item.setProperty("Accuracy", confusion.trace()/confusion.sum());
@@ -81,10 +96,10 @@ namespace track_select {
       if (type() == ACCURACY) {
         res = confusion.trace()/confusion.sum();
       } else if (type() == LOGPROB) {
-        for (auto& c : cls) {
-          res += std::log(std::get<1>(c)(std::get<0>(c)));
+        for (unsigned int i = 0; i < categories.size(); i++) {
+          res += std::log(probabilities(categories[i], i));
         }
-        res /= cls.size();
+        res /= categories.size();
 
       } else if (type() == F1_SCORE) {
         f1_score(confusion);
@@ -183,5 +198,13 @@ namespace track_select {
       parallel_exec_ = exec;
     }
 
+    void Classify::setThreadPool(parallel::ThreadPool& pool) {
+      thread_pool_ = &pool;
+    }
+
+    parallel::ThreadPool& Classify::threadPool() const {
+      return *thread_pool_;
+    }
+
   }
 }
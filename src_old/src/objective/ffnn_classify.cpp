@@ -1,18 +1,12 @@
 #include "objective/ffnn_classify.hpp"
 #include <set>
+#include <sstream>
+#include <algorithm>
+#include <type_traits>
 #include <track-select-msmm>
 
 namespace track_select {
   namespace objective {
-    real e(real x) {
-      return exp(x);
-    }
-
-    Vector softmax(Vector vec) {
-      vec = vec.unaryExpr(&e);
-      return vec/vec.sum();
-    }
-
     unsigned int FFNNClassify::calcParamsCount(unsigned int input_units,
                                                unsigned int hidden_units,
                                                unsigned int output_units) {
@@ -41,6 +35,13 @@ namespace track_select {
                                unsigned int hidden_units,
                                Classify::FitnessType fitness_type,
                                const data::FeatureVectorSet& data)
+      : FFNNClassify(p_size, hidden_units, fitness_type,
+                     data::FeatureVectorSetView(data)) {}
+
+    FFNNClassify::FFNNClassify(unsigned int p_size,
+                               unsigned int hidden_units,
+                               Classify::FitnessType fitness_type,
+                               const data::FeatureVectorSetView& data)
       : Classify(p_size,
                  calcParamsCount(data.dim(),
                                  hidden_units,
@@ -49,12 +50,51 @@ namespace track_select {
                  data.dim(),
                  calcCategoriesCount(data)),
       hidden_units_count_(hidden_units),
-      data_(&data) {}
+      data_(data) {
+      hidden_weights_ = layout_.add(hidden_units, inputDim());
+      hidden_biases_ = layout_.add(hidden_units);
+      output_weights_ = layout_.add(categoriesCount(), hidden_units);
+      output_biases_ = layout_.add(categoriesCount());
+
+      /* The optimisers size the candidates by calcParamsCount */
+      unsigned int params_count = calcParamsCount(inputDim(), hidden_units,
+                                                  categoriesCount());
+      if (layout_.size() != params_count) {
+        std::stringstream ss;
+        ss << "FFNNClassify: the layout has " << layout_.size()
+           << " parameters however the network has " << params_count;
+        throw ErrorInconsistentDim(ss.str());
+      }
+
+      std::shared_ptr<std::vector<unsigned short>>
+        targets(new std::vector<unsigned short>(data_.size()));
+      for (unsigned int i = 0; i < data_.size(); i++)
+        (*targets)[i] = data_[i].category();
+
+      readInputs();
+      targets_ = targets;
+    }
+
+    void FFNNClassify::readInputs() {
+      std::shared_ptr<Matrix> inputs(new Matrix(data_.dim(), data_.size()));
+      for (unsigned int i = 0; i < data_.size(); i++)
+        inputs->col(i) = data_[i];
+
+      inputs_ = inputs;
+    }
 
 
     FFNNClassify::FFNNClassify(const FFNNClassify& obj)
       : Classify((const Classify&)obj),
         hidden_units_count_(obj.hidden_units_count_),
+        layout_(obj.layout_),
+        hidden_weights_(obj.hidden_weights_),
+        hidden_biases_(obj.hidden_biases_),
+        output_weights_(obj.output_weights_),
+        output_biases_(obj.output_biases_),
+        inputs_(obj.inputs_),
+        inputs_float_(obj.inputs_float_),
+        targets_(obj.targets_),
         data_(obj.data_) {}
 
 
@@ -63,6 +103,14 @@ namespace track_select {
       Classify::operator=((const Classify&)obj);
       data_ = obj.data_ ;
       hidden_units_count_ = obj.hidden_units_count_;
+      layout_ = obj.layout_;
+      hidden_weights_ = obj.hidden_weights_;
+      hidden_biases_ = obj.hidden_biases_;
+      output_weights_ = obj.output_weights_;
+      output_biases_ = obj.output_biases_;
+      inputs_ = obj.inputs_;
+      inputs_float_ = obj.inputs_float_;
+      targets_ = obj.targets_;
 
       return *this;
     }
@@ -71,55 +119,99 @@ namespace track_select {
     optimizer::OptimizerReportItem
     FFNNClassify::operator()(const Vector& params) const {
 
-      nn::FeedForwardNetwork nn = buildFromParams(params);
-      // The matrix has the following convention (true label, preducted label);
-      std::vector<std::tuple<unsigned short, Vector>> class_probs;
-      for (auto& sample : (*data_))
-        class_probs.push_back(std::make_tuple(sample.category(),
-                                              softmax(nn(sample))));
-
-      optimizer::OptimizerReportItem item = buildItem(class_probs);
+      optimizer::OptimizerReportItem item =
+        buildItem(*targets_, classProbabilities(params));
       item.setVector(params);
       return item;
     }
 
-    nn::FeedForwardNetwork
-    FFNNClassify::buildFromParams(const Vector& params) const {
-      Matrix hidden_weights(hiddenUnitsCount(), inputDim());
-      Vector hidden_biases(hiddenUnitsCount());
-
-      Matrix output_weights(categoriesCount(), hiddenUnitsCount());
-      Vector output_biases(categoriesCount());
-
-      unsigned int index = 0;
-
-      for (unsigned int i = 0; i < hidden_weights.rows(); i++)
-        for (unsigned int j = 0; j < hidden_weights.cols(); j++)
-          hidden_weights(i, j) = params[index++];
-
-      for (unsigned int i = 0; i < hidden_biases.rows(); i++)
-        hidden_biases(i) = params[index++];
+    Matrix FFNNClassify::classProbabilities(const Vector& params) const {
+      if (singlePrecision())
+        return forward(params, *inputs_float_);
+      return forward(params, *inputs_);
+    }
 
-      for (unsigned int i = 0; i < output_weights.rows(); i++)
-        for (unsigned int j = 0; j < output_weights.cols(); j++)
-          output_weights(i, j) = params[index++];
+    /* The network of buildFromParams run on blocks of points. In double
+     * the weights are read in place from params, and the activations of a
+     * block stay in cache between the layers. */
+    template <class matrix_type>
+    Matrix FFNNClassify::forward(const Vector& params,
+                                 const matrix_type& inputs) const {
+      typedef typename matrix_type::Scalar scalar;
+      typedef Eigen::Matrix<scalar, Eigen::Dynamic, Eigen::Dynamic> matrix;
+      typedef Eigen::Matrix<scalar, Eigen::Dynamic, 1> vector;
+      const bool InPlace = std::is_same<scalar, real>::value;
+      typedef typename std::conditional<InPlace, ParamLayout::MatrixView,
+                                        matrix>::type weights_type;
+      typedef typename std::conditional<InPlace, ParamLayout::VectorView,
+                                        vector>::type biases_type;
+      const unsigned int Block = 512;
+
+      unsigned int categories = categoriesCount();
+
+      weights_type hidden_weights(
+        layout_.matrix(params, hidden_weights_).template cast<scalar>());
+      biases_type hidden_biases(
+        layout_.vector(params, hidden_biases_).template cast<scalar>());
+      weights_type output_weights(
+        layout_.matrix(params, output_weights_).template cast<scalar>());
+      biases_type output_biases(
+        layout_.vector(params, output_biases_).template cast<scalar>());
+
+      Matrix probabilities(categories, inputs.cols());
+      matrix h;
+      matrix o;
+      for (unsigned int begin = 0; begin < inputs.cols(); begin += Block) {
+        unsigned int size = std::min<unsigned int>(Block, inputs.cols() - begin);
+
+        h.noalias() = hidden_weights * inputs.middleCols(begin, size);
+        h.colwise() += hidden_biases;
+        h = (scalar(1) + (-h.array()).exp()).inverse().matrix();
+
+        o.noalias() = output_weights * h;
+        o.colwise() += output_biases;
+
+        /* Sigmoid output layer and softmax in one pass */
+        o = (scalar(1) + (-o.array()).exp()).inverse().exp().matrix();
+        o.array().rowwise() /= o.colwise().sum().array();
+
+        probabilities.middleCols(begin, size) = o.template cast<real>();
+      }
+
+      return probabilities;
+    }
 
-      for (unsigned int i = 0; i < output_biases.rows(); i++)
-        output_biases(i) = params[index++];
+    void FFNNClassify::setSinglePrecision(bool single) {
+      if (single == singlePrecision()) return;
+
+      /* Clones still evaluating in real keep their copy alive */
+      if (single) {
+        inputs_float_.reset(new MatrixF(inputs_->cast<float>()));
+        inputs_.reset();
+      } else {
+        readInputs();
+        inputs_float_.reset();
+      }
+    }
 
+    bool FFNNClassify::singlePrecision() const {
+      return (bool)inputs_float_;
+    }
 
+    nn::FeedForwardNetwork
+    FFNNClassify::buildFromParams(const Vector& params) const {
       return nn::FeedForwardNetwork({
-          std::make_tuple(hidden_weights,
-                          hidden_biases,
+          std::make_tuple(Matrix(layout_.matrix(params, hidden_weights_)),
+                          Vector(layout_.vector(params, hidden_biases_)),
                           nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
-            std::make_tuple(output_weights,
-                            output_biases,
+            std::make_tuple(Matrix(layout_.matrix(params, output_weights_)),
+                            Vector(layout_.vector(params, output_biases_)),
                             nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
     }
 
 
-    const data::FeatureVectorSet& FFNNClassify::data() const {
-      return *data_;
+    const data::FeatureVectorSetView& FFNNClassify::data() const {
+      return data_;
     }
 
 
@@ -1,5 +1,6 @@
 #include "objective/hmm.hpp"
 #include <algorithm>
+#include <sstream>
 #include <tuple>
 
 namespace track_select {
@@ -20,6 +21,14 @@ namespace track_select {
              unsigned int hidden_states,
              HMM::FitnessType fitness_type,
              const data::SequenceSet& data)
+      : HMM(p_size, hidden_units, hidden_states, fitness_type,
+            data::SequenceSetView(data)) {}
+
+    HMM::HMM(unsigned int p_size,
+             unsigned int hidden_units,
+             unsigned int hidden_states,
+             HMM::FitnessType fitness_type,
+             const data::SequenceSetView& data)
       : Classify(p_size,
                  calcNNHMMParams(hidden_units,
                                  hidden_states,
@@ -30,10 +39,24 @@ namespace track_select {
                  calcCategoriesCount(data)),
         hidden_units_count_(hidden_units),
         hidden_states_count_(hidden_states),
-      data_(&data) {
+      data_(data),
+      arena_(new data::SequenceArena(data)),
+      forward_(new HMMForward(arena_)) {
+      buildLayout();
+
+      /* The optimisers size the candidates by calcNNHMMParams */
+      unsigned int params_count = calcNNHMMParams(hidden_units, hidden_states,
+                                                  inputDim(), categoriesCount());
+      if (layout_.size() != params_count) {
+        std::stringstream ss;
+        ss << "HMM: the layout has " << layout_.size()
+           << " parameters however the model has " << params_count;
+        throw ErrorInconsistentDim(ss.str());
+      }
 
       priors_ = Vector::Zero(categoriesCount());
-      for (auto& s : (*data_)) priors_(s.category())++;
+      for (unsigned int s = 0; s < arena_->size(); s++)
+        priors_(arena_->category(s))++;
 
       priors_ /= priors_.sum();
     }
@@ -43,7 +66,11 @@ namespace track_select {
       : Classify((const Classify&)obj),
         hidden_units_count_(obj.hidden_units_count_),
         hidden_states_count_(obj.hidden_states_count_),
+        layout_(obj.layout_),
+        blocks_(obj.blocks_),
         data_(obj.data_),
+        arena_(obj.arena_),
+        forward_(obj.forward_),
         priors_(obj.priors_) {}
 
 
@@ -52,8 +79,12 @@ namespace track_select {
       ObjectiveFunc::operator=((const ObjectiveFunc&)obj);
       hidden_units_count_ = obj.hidden_units_count_;
       hidden_states_count_ = obj.hidden_states_count_;
+      layout_ = obj.layout_;
+      blocks_ = obj.blocks_;
 
       data_ = obj.data_ ;
+      arena_ = obj.arena_;
+      forward_ = obj.forward_;
       priors_ = obj.priors_;
 
       return *this;
@@ -61,19 +92,28 @@ namespace track_select {
 
     optimizer::OptimizerReportItem
     HMM::operator()(const Vector& params) const {
-      std::vector<hmm::NNHMM> cls = buildFromParams(params);
+      /* The log likelihood of every sequence under every model, a column
+       * per sequence. The networks are read in place from params. */
+      Matrix log_probs(categoriesCount(), arena_->size());
+      for (unsigned int c_i = 0; c_i < categoriesCount(); c_i++) {
+        const CategoryBlocks& blocks = blocks_[c_i];
 
-      std::vector<std::tuple<unsigned short, Vector>> class_probs;
-      // The matrix has the following convention (true label, preducted label);
+        Vector pi = layout_.vector(params, blocks.pi);
+        Matrix tr = layout_.matrix(params, blocks.tr);
+        hmm::NNHMM::normalize(pi, tr);
+
+        std::vector<HMMForward::NNEmissionView> em;
+        for (const StateBlocks& state : blocks.states)
+          em.push_back({layout_.matrix(params, state.hidden_weights),
+                layout_.vector(params, state.hidden_biases),
+                layout_.matrix(params, state.output_weights),
+                layout_.vector(params, state.output_bias)});
 
-      for (auto& sample : (*data_)) {
-        Vector log_probs(cls.size());
-        for (unsigned int i = 0; i < cls.size(); i++)
-          log_probs(i) = cls[i].p(sample.begin(), sample.end());
-        class_probs.push_back(std::make_tuple(sample.category(), log_probs));
+        log_probs.row(c_i) = forward_->logLikelihood(pi, tr, em).transpose();
       }
 
-      optimizer::OptimizerReportItem item = buildItem(class_probs);
+      optimizer::OptimizerReportItem item =
+        buildItem(arena_->categories(), log_probs);
       item.setVector(params);
       return item;
     }
@@ -81,59 +121,57 @@ namespace track_select {
     std::vector<hmm::NNHMM>
     HMM::buildFromParams(const Vector& params) const {
       std::vector<hmm::NNHMM> res;
-      unsigned int index = 0;
-
-      for (unsigned int c_i = 0; c_i < categoriesCount(); c_i++) {
-        // Build the initial state probability vector
-        Vector pi(hiddenStatesCount());
-        for (unsigned int s_i = 0; s_i < hiddenStatesCount(); s_i++)
-          pi(s_i) = params(index++);
+      for (auto& model : modelsFromParams(params))
+        res.push_back(hmm::NNHMM(model.pi, model.tr, model.em));
 
+      return res;
+    }
 
-        // Build the transition probabilites
-        Matrix tr(hiddenStatesCount(), hiddenStatesCount());
-        for (unsigned int s1_i = 0; s1_i < hiddenStatesCount(); s1_i++)
-          for (unsigned int s2_i = 0; s2_i < hiddenStatesCount(); s2_i++)
-            tr(s1_i, s2_i) = params(index++);
-
-        hmm::NNHMM::normalize(pi, tr);
-
-        std::vector<std::vector<nn::FeedForwardNetwork::layer>> em;
-        for (unsigned int states_i = 0; states_i < hiddenStatesCount();
-             states_i++) {
-
-          Vector hidden_biases(hiddenUnitsCount());
-          Matrix hidden_weights(hiddenUnitsCount(), inputDim());
-          Vector output_biases(1);
-          Matrix output_weights(1, hiddenUnitsCount());
-
-          for (unsigned int hu = 0; hu < hiddenUnitsCount(); hu++)
-            hidden_biases(hu) = params(index++);
-
-          for (unsigned int hu = 0; hu < hiddenUnitsCount(); hu++)
-            for (unsigned int i = 0; i < inputDim(); i++)
-              hidden_weights(hu, i) = params(index++);
-
-
-          output_biases(0) = params(index++);
-
-          for (unsigned int hu = 0; hu < hiddenUnitsCount(); hu++)
-            output_weights(0, hu) = params(index++);
-
-          em.push_back({
-              std::make_tuple(hidden_weights, hidden_biases,
-                              nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
-                std::make_tuple(output_weights, output_biases,
-                                nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
-        } // endfor states
+    void HMM::buildLayout() {
+      blocks_.resize(categoriesCount());
+      for (auto& category : blocks_) {
+        category.pi = layout_.add(hiddenStatesCount());
+        category.tr = layout_.add(hiddenStatesCount(), hiddenStatesCount());
+
+        category.states.resize(hiddenStatesCount());
+        for (auto& state : category.states) {
+          state.hidden_biases = layout_.add(hiddenUnitsCount());
+          state.hidden_weights = layout_.add(hiddenUnitsCount(), inputDim());
+          state.output_bias = layout_.add(1);
+          state.output_weights = layout_.add(1, hiddenUnitsCount());
+        }
+      }
+    }
 
-        res.push_back(hmm::NNHMM(pi, tr, em));
-      } // endfor category
+    std::vector<HMM::Model>
+    HMM::modelsFromParams(const Vector& params) const {
+      std::vector<Model> res;
+      for (unsigned int c_i = 0; c_i < categoriesCount(); c_i++)
+        res.push_back(modelFromParams(params, c_i));
 
       return res;
     }
 
-
+    HMM::Model HMM::modelFromParams(const Vector& params,
+                                    unsigned int category) const {
+      const CategoryBlocks& blocks = blocks_[category];
+
+      Model model;
+      model.pi = layout_.vector(params, blocks.pi);
+      model.tr = layout_.matrix(params, blocks.tr);
+      hmm::NNHMM::normalize(model.pi, model.tr);
+
+      for (const StateBlocks& state : blocks.states)
+        model.em.push_back({
+            std::make_tuple(Matrix(layout_.matrix(params, state.hidden_weights)),
+                            Vector(layout_.vector(params, state.hidden_biases)),
+                            nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
+              std::make_tuple(Matrix(layout_.matrix(params, state.output_weights)),
+                              Vector(layout_.vector(params, state.output_bias)),
+                              nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
+
+      return model;
+    }
 
     HMM* HMM::clone() const {
       return new HMM(*this);
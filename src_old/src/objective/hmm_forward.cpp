@@ -0,0 +1,199 @@
+#include "objective/hmm_forward.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace track_select {
+  namespace objective {
+
+    /* log(1 / (1 + e^-x)) without rounding 1 + e^-x */
+    static real logSigmoid(real x) {
+      return x > 0 ? -std::log1p(std::exp(-x)) : x - std::log1p(std::exp(x));
+    }
+
+    HMMForward::HMMForward(
+      const std::shared_ptr<const data::SequenceArena>& arena,
+      unsigned int lanes)
+      : arena_(arena), lanes_(std::max(1u, lanes)), order_(arena->size()) {
+      std::iota(order_.begin(), order_.end(), 0);
+      std::stable_sort(order_.begin(), order_.end(),
+                       [this](unsigned int a, unsigned int b) {
+                         return arena_->length(a) > arena_->length(b);
+                       });
+    }
+
+    const data::SequenceArena& HMMForward::arena() const {
+      return *arena_;
+    }
+
+    Vector HMMForward::logLikelihood(const Vector& pi, const Matrix& tr,
+                                     const Matrix& log_emissions) const {
+      const real Infinity = std::numeric_limits<real>::infinity();
+      unsigned int states = pi.size();
+      const std::vector<unsigned int>& offsets = arena_->offsets();
+
+      if (tr.rows() != states || tr.cols() != states ||
+          log_emissions.rows() != states ||
+          log_emissions.cols() != arena_->frames().cols())
+        throw ErrorInconsistentDim("HMMForward::logLikelihood");
+
+      /* Each frame scaled by its most likely state, the scale is added back
+       * to the log likelihood */
+      Eigen::Matrix<real, 1, Eigen::Dynamic> scale =
+        log_emissions.colwise().maxCoeff();
+      scale = (scale.array() == -Infinity).select(0, scale);
+      /* Eigen's exp clamps its argument, so impossible frames are set to
+       * 0 rather than left at the smallest double */
+      Matrix emissions = (log_emissions.array() == -Infinity).select(
+        0, (log_emissions.rowwise() - scale).array().exp()).matrix();
+
+      Matrix transposed = tr.transpose();
+      Vector result = Vector::Zero(arena_->size());
+
+      Matrix alpha(states, lanes_);
+      Matrix next(states, lanes_);
+      Eigen::Matrix<real, 1, Eigen::Dynamic> norm(lanes_);
+      Vector log_likelihood(lanes_);
+
+      for (unsigned int first = 0; first < order_.size(); first += lanes_) {
+        unsigned int lanes = std::min<unsigned int>(lanes_,
+                                                    order_.size() - first);
+        const unsigned int* batch = &order_[first];
+        unsigned int active = lanes;
+        log_likelihood.head(lanes).setZero();
+
+        for (unsigned int t = 0; t < arena_->length(batch[0]); t++) {
+          while (arena_->length(batch[active - 1]) <= t) active--;
+
+          for (unsigned int l = 0; l < active; l++) {
+            unsigned int frame = offsets[batch[l]] + t;
+            next.col(l) = emissions.col(frame);
+            log_likelihood(l) += scale(frame);
+          }
+
+          if (t == 0)
+            alpha.leftCols(active) =
+              next.leftCols(active).array().colwise() * pi.array();
+          else
+            alpha.leftCols(active) =
+              (transposed * alpha.leftCols(active)).cwiseProduct(
+                next.leftCols(active));
+
+          norm.head(active) = alpha.leftCols(active).colwise().sum();
+          for (unsigned int l = 0; l < active; l++) {
+            if (norm(l) > 0) {
+              alpha.col(l) /= norm(l);
+              log_likelihood(l) += std::log(norm(l));
+            } else {
+              log_likelihood(l) = -Infinity;
+            }
+          }
+        }
+
+        for (unsigned int l = 0; l < lanes; l++)
+          result(batch[l]) = log_likelihood(l);
+      }
+
+      return result;
+    }
+
+    Matrix HMMForward::logEmissions(
+      const std::vector<std::vector<nn::FeedForwardNetwork::layer>>& em,
+      const Matrix& frames) {
+      Matrix result(em.size(), frames.cols());
+
+      for (unsigned int s = 0; s < em.size(); s++) {
+        if (em[s].empty() || std::get<2>(em[s].back()) !=
+            nn::FeedForwardNetwork::SIGMOID_ACTIVATION) {
+          std::stringstream ss;
+          ss << "HMMForward::logEmissions the network of state " << s
+             << " needs a sigmoid output";
+          throw hmm::ErrorHMM(ss.str().c_str());
+        }
+
+        Matrix values = frames;
+        for (unsigned int l = 0; l < em[s].size(); l++) {
+          const auto& layer = em[s][l];
+          Matrix z = std::get<0>(layer) * values;
+          z.colwise() += std::get<1>(layer);
+
+          bool sigmoid = std::get<2>(layer) ==
+            nn::FeedForwardNetwork::SIGMOID_ACTIVATION;
+          if (l + 1 < em[s].size())
+            values = sigmoid ?
+              (1 + (-z.array()).exp()).inverse().matrix() : z;
+          else
+            result.row(s) = z.row(0).unaryExpr(&logSigmoid);
+        }
+      }
+
+      return result;
+    }
+
+    Matrix HMMForward::logEmissions(const std::vector<NNEmissionView>& em,
+                                    const Matrix& frames) {
+      Matrix result(em.size(), frames.cols());
+      Matrix hidden;
+
+      for (unsigned int s = 0; s < em.size(); s++) {
+        hidden.noalias() = em[s].hidden_weights * frames;
+        hidden.colwise() += em[s].hidden_biases;
+        hidden = (1 + (-hidden.array()).exp()).inverse().matrix();
+
+        result.row(s).noalias() = em[s].output_weights * hidden;
+        result.row(s) = (result.row(s).array() + em[s].output_bias(0)).matrix()
+          .unaryExpr(&logSigmoid);
+      }
+
+      return result;
+    }
+
+    Matrix HMMForward::logEmissions(
+      const std::vector<std::tuple<Vector, Matrix>>& em,
+      const Matrix& frames) {
+      Matrix result(em.size(), frames.cols());
+
+      for (unsigned int s = 0; s < em.size(); s++) {
+        const Vector& mean = std::get<0>(em[s]);
+        Eigen::LLT<Matrix> llt(std::get<1>(em[s]));
+        if (llt.info() != Eigen::Success) {
+          std::stringstream ss;
+          ss << "HMMForward::logEmissions covariance of state " << s
+             << " is not positive definite";
+          throw hmm::ErrorHMM(ss.str().c_str());
+        }
+
+        /* With the covariance L L^T the exponent is -|L^-1 (x - mean)|^2 / 2
+         * and the determinant the square of the product of diag(L) */
+        Matrix z = frames.colwise() - mean;
+        llt.matrixL().solveInPlace(z);
+
+        real log_norm = -0.5 * mean.size() * std::log(2 * M_PI) -
+          llt.matrixLLT().diagonal().array().log().sum();
+        result.row(s) = (-0.5 * z.colwise().squaredNorm()).array() + log_norm;
+      }
+
+      return result;
+    }
+
+    Matrix HMMForward::logEmissions(const Matrix& em, const Matrix& frames) {
+      const real Infinity = std::numeric_limits<real>::infinity();
+      Matrix result(em.cols(), frames.cols());
+
+      for (unsigned int f = 0; f < frames.cols(); f++) {
+        real symbol = frames(0, f);
+        if (symbol < 0 || symbol >= em.rows())
+          result.col(f).setConstant(-Infinity);
+        else
+          result.col(f) = em.row((unsigned int)symbol).transpose()
+            .unaryExpr([](real p) { return std::log(p); });
+      }
+
+      return result;
+    }
+
+  }
+}
@@ -0,0 +1,49 @@
+#include "objective/param_layout.hpp"
+
+#include <sstream>
+
+namespace track_select {
+  namespace objective {
+
+    ParamLayout::ParamLayout() : size_(0) {}
+
+    unsigned int ParamLayout::add(unsigned int rows, unsigned int cols) {
+      Block block = {size_, rows, cols};
+      blocks_.push_back(block);
+      size_ += rows * cols;
+      return blocks_.size() - 1;
+    }
+
+    unsigned int ParamLayout::size() const {
+      return size_;
+    }
+
+    unsigned int ParamLayout::offset(unsigned int block) const {
+      return blocks_.at(block).offset;
+    }
+
+    void ParamLayout::check(const Vector& params) const {
+      if (params.size() < size()) {
+        std::stringstream ss;
+        ss << "ParamLayout: params should have " << size()
+           << " values however it has " << params.size();
+        throw ErrorInconsistentDim(ss.str());
+      }
+    }
+
+    ParamLayout::MatrixView
+    ParamLayout::matrix(const Vector& params, unsigned int block) const {
+      check(params);
+      const Block& b = blocks_.at(block);
+      return MatrixView(params.data() + b.offset, b.rows, b.cols);
+    }
+
+    ParamLayout::VectorView
+    ParamLayout::vector(const Vector& params, unsigned int block) const {
+      check(params);
+      const Block& b = blocks_.at(block);
+      return VectorView(params.data() + b.offset, b.rows * b.cols);
+    }
+
+  }
+}
@@ -0,0 +1,180 @@
+#include "parallel/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace track_select {
+  namespace parallel {
+
+    class ThreadPool::Loop {
+      std::function<void(unsigned int)> body_;
+      unsigned long end_;
+      unsigned long chunk_;
+      unsigned long count_;
+
+      std::atomic<unsigned long> next_;
+      std::atomic<unsigned long> finished_;
+
+      std::mutex lock_;
+      std::condition_variable done_;
+      std::exception_ptr error_;
+
+    public:
+      Loop(unsigned int begin, unsigned int end, unsigned int chunk,
+           const std::function<void(unsigned int)>& body)
+        : body_(body),
+          end_(end),
+          chunk_(chunk),
+          count_(end - begin),
+          next_(begin),
+          finished_(0) {}
+
+      /** @return false if no chunk was left */
+      bool runChunk() {
+        unsigned long begin = next_.fetch_add(chunk_);
+        if (begin >= end_) return false;
+        unsigned long end = std::min(begin + chunk_, end_);
+
+        try {
+          for (unsigned long i = begin; i < end; i++)
+            body_(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(lock_);
+          if (!error_) error_ = std::current_exception();
+        }
+
+        if (finished_.fetch_add(end - begin) + (end - begin) == count_) {
+          std::lock_guard<std::mutex> lock(lock_);
+          done_.notify_all();
+        }
+        return true;
+      }
+
+      bool exhausted() const {
+        return next_.load() >= end_;
+      }
+
+      void wait() {
+        std::unique_lock<std::mutex> lock(lock_);
+        done_.wait(lock, [this]() { return finished_.load() == count_; });
+        if (error_) std::rethrow_exception(error_);
+      }
+    };
+
+    /* The pool and queue of the worker running on this thread */
+    static thread_local const ThreadPool* current_pool = 0;
+    static thread_local unsigned int current_queue = 0;
+
+    ThreadPool::ThreadPool(unsigned int threads)
+      : epoch_(0), stop_(false) {
+      unsigned int workers = threads > 1 ? threads - 1 : 0;
+      for (unsigned int i = 0; i <= workers; i++)
+        queues_.push_back(std::unique_ptr<Queue>(new Queue));
+
+      for (unsigned int i = 0; i < workers; i++)
+        workers_.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+
+    ThreadPool::~ThreadPool() {
+      {
+        std::lock_guard<std::mutex> lock(sleep_lock_);
+        stop_ = true;
+      }
+      wake_.notify_all();
+
+      for (auto& t : workers_)
+        t.join();
+    }
+
+    unsigned int ThreadPool::size() const {
+      return workers_.size() + 1;
+    }
+
+    unsigned int ThreadPool::queueOfCaller() const {
+      return current_pool == this ? current_queue : queues_.size() - 1;
+    }
+
+    void ThreadPool::remove(Queue& queue, const std::shared_ptr<Loop>& loop) {
+      std::lock_guard<std::mutex> lock(queue.lock);
+      auto it = std::find(queue.loops.begin(), queue.loops.end(), loop);
+      if (it != queue.loops.end()) queue.loops.erase(it);
+    }
+
+    bool ThreadPool::steal(unsigned int me) {
+      /* The own queue newest first, then the others oldest first */
+      for (unsigned int q = 0; q < queues_.size(); q++) {
+        Queue& queue = *queues_[(me + q) % queues_.size()];
+
+        while (true) {
+          std::shared_ptr<Loop> loop;
+          {
+            std::lock_guard<std::mutex> lock(queue.lock);
+            if (queue.loops.empty()) break;
+            loop = q ? queue.loops.front() : queue.loops.back();
+          }
+
+          if (loop->runChunk()) return true;
+          remove(queue, loop);
+        }
+      }
+
+      return false;
+    }
+
+    void ThreadPool::work(unsigned int me) {
+      current_pool = this;
+      current_queue = me;
+
+      while (true) {
+        unsigned long seen;
+        {
+          std::lock_guard<std::mutex> lock(sleep_lock_);
+          if (stop_) return;
+          seen = epoch_;
+        }
+
+        if (steal(me)) continue;
+
+        std::unique_lock<std::mutex> lock(sleep_lock_);
+        wake_.wait(lock, [&]() { return stop_ || epoch_ != seen; });
+      }
+    }
+
+    void ThreadPool::parallelFor(unsigned int begin, unsigned int end,
+                                 unsigned int chunk,
+                                 const std::function<void(unsigned int)>& body) {
+      if (end <= begin) return;
+
+      if (!chunk)
+        chunk = std::max(1u, (end - begin) / (4 * size()));
+
+      std::shared_ptr<Loop> loop(new Loop(begin, end, chunk, body));
+
+      if (workers_.empty() || end - begin <= chunk) {
+        while (loop->runChunk());
+        loop->wait();
+        return;
+      }
+
+      Queue& queue = *queues_[queueOfCaller()];
+      {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.loops.push_back(loop);
+      }
+      {
+        std::lock_guard<std::mutex> lock(sleep_lock_);
+        epoch_++;
+      }
+      wake_.notify_all();
+
+      while (loop->runChunk());
+      remove(queue, loop);
+      loop->wait();
+    }
+
+    ThreadPool& ThreadPool::global() {
+      static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+      return pool;
+    }
+
+  }
+}
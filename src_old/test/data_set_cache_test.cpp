@@ -0,0 +1,84 @@
+#include "data/data_set_cache.hpp"
+#include "data/sequence_set.hpp"
+#include "data/feature_vector_set.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+namespace td = track_select::data;
+namespace ts = track_select;
+int main(int argc, char** argv) {
+  char directory[] = "/tmp/data-set-cache-test-XXXXXX";
+  if (!mkdtemp(directory)) return -1;
+  td::DataSetCache cache(directory);
+  if (cache.entries().size()) return -1;
+
+  td::SequenceSet set("Dummy Set", {"x", "y", "z"});
+  set.setId(7);
+  for (unsigned int i = 0; i < 5; i++) {
+    td::Sequence seq;
+    for (unsigned int f = 0; f < i + 1; f++)
+      seq << ts::Vector::Random(3);
+    if (i % 2) seq.setCategory(i % 3);
+    if (i != 2) seq.setSourceDataSet(i < 3 ? "first" : "second");
+    seq.setSourceTrackId(10 + i);
+    seq.setSourceRange(ts::msmm::CustomRange(i, 2 * i));
+    set << seq;
+  }
+  cache.save(set, "stamp");
+
+  if (cache.entries() != std::vector<ts::database_id>{7}) return -1;
+
+  td::SequenceSet stale("Dummy Set", {"x", "y", "z"});
+  if (cache.load(7, "other stamp", stale)) return -1;
+  if (cache.load(8, "stamp", stale)) return -1;
+
+  td::FeatureVectorSet other_type("Dummy Set");
+  if (cache.load(7, "stamp", other_type)) return -1;
+
+  td::SequenceSet from_cache("Dummy Set", {"x", "y", "z"});
+  if (!cache.load(7, "stamp", from_cache)) return -1;
+  if (from_cache.size() != set.size()) return -1;
+  if (from_cache.dim() != 3) return -1;
+  for (unsigned int i = 0; i < set.size(); i++) {
+    if (from_cache[i].owner() != &from_cache) return -1;
+    if (from_cache[i].hasId() != set[i].hasId()) return -1;
+    if (from_cache[i].categorySet() != set[i].categorySet()) return -1;
+    if (from_cache[i].sourceDataSetSet() != set[i].sourceDataSetSet()) return -1;
+    if (!(from_cache[i].matrix() == set[i].matrix())) return -1;
+    if (from_cache[i].sourceTrackId() != set[i].sourceTrackId()) return -1;
+    if (set[i].sourceDataSetSet() &&
+        from_cache[i].sourceDataSet() != set[i].sourceDataSet()) return -1;
+  }
+
+  td::FeatureVectorSet vectors("Dummy Set");
+  vectors.setId(8);
+  for (unsigned int i = 0; i < 3; i++)
+    vectors << td::FeatureVector(ts::Vector::Random(4));
+  cache.save(vectors, "stamp");
+
+  td::FeatureVectorSet vectors_from_cache("Dummy Set");
+  if (!cache.load(8, "stamp", vectors_from_cache)) return -1;
+  if (vectors_from_cache.size() != 3) return -1;
+  for (unsigned int i = 0; i < vectors.size(); i++)
+    if ((ts::Vector)vectors_from_cache[i] != (ts::Vector)vectors[i]) return -1;
+
+  {
+    std::ofstream damaged(cache.path(9).c_str());
+    damaged << "not a cache file";
+  }
+  try {
+    cache.load(9, "stamp", vectors_from_cache);
+    return -1;
+  } catch (td::ErrorDataSetCache e) {}
+
+  cache.invalidate(7);
+  if (cache.load(7, "stamp", stale)) return -1;
+
+  cache.purge();
+  if (cache.entries().size()) return -1;
+  rmdir(directory);
+
+  return 0;
+}
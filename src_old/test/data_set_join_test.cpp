@@ -0,0 +1,81 @@
+#include "data/data_set_join.hpp"
+#include "data/sequence_set.hpp"
+#include "data/feature_vector_set.hpp"
+
+namespace td = track_select::data;
+namespace ts = track_select;
+int main(int argc, char** argv) {
+  /* Tracks 0 to 9 of two sources, every third one with two score vectors */
+  td::FeatureVectorSet scores;
+  for (unsigned int i = 0; i < 20; i++) {
+    unsigned int copies = i % 3 ? 1 : 2;
+    for (unsigned int c = 0; c < copies; c++) {
+      td::FeatureVector vector(ts::Vector::Constant(2, i * 10 + c));
+      vector.setSourceDataSet(i < 10 ? "first" : "second");
+      vector.setSourceTrackId(i % 10);
+      vector.setSourceRange(ts::msmm::CustomRange(0, c + 1));
+      scores << vector;
+    }
+  }
+
+  /* Sequences of the tracks in reverse, track 4 of "second" missing, one
+   * sequence of an unknown source and one without attributes */
+  td::SequenceSet tracks;
+  for (unsigned int i = 20; i-- > 0; ) {
+    if (i == 14) continue;
+    td::Sequence seq;
+    seq << ts::Vector::Constant(2, i);
+    seq.setSourceDataSet(i < 10 ? "first" : "second");
+    seq.setSourceTrackId(i % 10);
+    seq.setSourceRange(ts::msmm::CustomRange(0, 1));
+    tracks << seq;
+  }
+  td::Sequence unknown;
+  unknown << ts::Vector::Zero(2);
+  unknown.setSourceDataSet("third");
+  unknown.setSourceTrackId(0);
+  tracks << unknown;
+  td::Sequence no_attributes;
+  no_attributes << ts::Vector::Zero(2);
+  tracks << no_attributes;
+
+  auto pairs = td::join(td::SequenceSetView(tracks),
+                        td::FeatureVectorSetView(scores));
+  if (pairs.first.size() != pairs.second.size()) return -1;
+  /* 19 tracks, 7 of them (0, 3, 6, 9 of first and 2, 5, 8 of second) with
+   * two vectors */
+  if (pairs.first.size() != 26) return -1;
+
+  for (unsigned int i = 0; i < pairs.first.size(); i++) {
+    if (pairs.first[i].sourceDataSetId() != pairs.second[i].sourceDataSetId())
+      return -1;
+    if (pairs.first[i].sourceTrackId() != pairs.second[i].sourceTrackId())
+      return -1;
+  }
+
+  /* In the order of the probe, then of the index */
+  if (&pairs.first[0] != &tracks[0]) return -1;
+  if (pairs.second[0](0) != 190) return -1;
+  if (&pairs.first[1] != &tracks[1]) return -1;
+  if (pairs.second[1](0) != 180) return -1;
+  if (&pairs.first[2] != &tracks[1]) return -1;
+  if (pairs.second[2](0) != 181) return -1;
+  if (&pairs.first[3] != &tracks[2]) return -1;
+
+  /* Matching the ranges leaves one vector per track */
+  td::JoinIndex<td::FeatureVector> index(scores, true);
+  auto ranged = index.join(td::SequenceSetView(tracks));
+  if (ranged.first.size() != 19) return -1;
+  for (unsigned int i = 0; i < ranged.second.size(); i++)
+    if (ranged.second[i].sourceRange().high() != 1) return -1;
+
+  /* The index is reused for several probes */
+  auto again = index.join(td::SequenceSetView(tracks).subset(0, 2));
+  if (again.first.size() != 2) return -1;
+
+  auto empty = td::join(td::SequenceSetView(tracks),
+                        td::FeatureVectorSetView(td::FeatureVectorSet()));
+  if (empty.first.size() != 0) return -1;
+
+  return 0;
+}
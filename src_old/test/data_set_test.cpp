@@ -1,5 +1,6 @@
 #include "data/data_set.hpp"
 #include "data/feature_vector.hpp"
+#include "data/stored_data.hpp"
 #include "fixtures.hpp"
 
 namespace ts = track_select;
@@ -75,6 +76,45 @@ int main(int argc, char** argv) {
   for (unsigned int i = 0; i < clone2.size(); i++)
     if (clone2[i] != data_set[i]) return -1;
 
+  std::vector<ts::data::DataSetBuilder<ts::data::FeatureVector>> builders(2);
+  builders[0] << data_1;
+  builders[1] << data_2 << data_1;
+  try {
+    builders[1] << ts::data::FeatureVector(ts::Vector::Random(2));
+    return -1;
+  } catch (ts::ErrorInconsistentDim e) {
+    if (e.what() != std::string("DataSetBuilder: data dim should be 5 however "
+                                "it is 2")) return -1;
+  }
+
+  ts::data::DataSet<ts::data::FeatureVector> merged;
+  merged.merge(builders);
+  if (merged.dim() != 5) return -1;
+  if (merged.size() != 3) return -1;
+  if (builders[0].size() || builders[1].size()) return -1;
+  if (merged[0] != data_1 || merged[1] != data_2 || merged[2] != data_1)
+    return -1;
+  if (merged[2].owner() != &merged || merged[0].hasId()) return -1;
+
+  ts::data::DataSetBuilder<ts::data::FeatureVector> builder;
+  builder << ts::data::FeatureVector(ts::Vector::Random(2));
+  try {
+    merged.merge(builder);
+    return -1;
+  } catch (ts::ErrorInconsistentDim e) {}
+  if (merged.size() != 3) return -1;
+
+  /* A rejected merge leaves an empty set without a dim */
+  std::vector<ts::data::DataSetBuilder<ts::data::FeatureVector>> mixed(2);
+  mixed[0] << data_1;
+  mixed[1] << ts::data::FeatureVector(ts::Vector::Random(2));
+  ts::data::DataSet<ts::data::FeatureVector> empty;
+  try {
+    empty.merge(mixed);
+    return -1;
+  } catch (ts::ErrorInconsistentDim e) {}
+  if (empty.dimSet() || empty.size()) return -1;
+
   pqxx::connection conn("dbname=test");
   {
     pqxx::work w(conn);
@@ -108,5 +148,50 @@ int main(int argc, char** argv) {
   for (unsigned int i = 0; i < from_db.size(); i++)
     if (from_db[i] != data_set[i]) return -1;
 
+  ts::database_id float_id;
+  {
+    pqxx::work w(conn);
+    float_id = data_set.store(w, sizeof(float));
+    w.commit();
+  }
+  {
+    pqxx::work w(conn);
+    pqxx::result records = w.exec("select * from sequence where "
+                                  "sequence_set_id = " +
+                                  std::to_string(float_id) + " order by id");
+    if (records.size() != data_set.size()) return -1;
+
+    ts::data::StoredData stored(records[0]);
+    if (stored.typeSize() != sizeof(float)) return -1;
+    if (stored.rows() != 5 || stored.cols() != 1) return -1;
+    if (!stored.floats().col(0).isApprox(data_set[0].cast<float>())) return -1;
+    try {
+      stored.as<double>();
+      return -1;
+    } catch (ts::ErrorInconsistentDataType e) {}
+
+    ts::data::DataSet<ts::data::FeatureVector> from_float =
+      ts::data::DataSet<ts::data::FeatureVector>::read(float_id, w);
+    if (from_float.size() != data_set.size()) return -1;
+    for (unsigned int i = 0; i < from_float.size(); i++)
+      if (!from_float[i].isApprox(data_set[i], 1e-6)) return -1;
+  }
+
+  {
+    pqxx::work w(conn);
+    ts::data::DataSetStream<ts::data::FeatureVector> stream =
+      ts::data::DataSet<ts::data::FeatureVector>::stream(id, w, 1);
+    if (stream.header().size() != 0) return -1;
+    if (stream.header().info() != data_set.info()) return -1;
+
+    unsigned int index = 0;
+    for (ts::data::DataSet<ts::data::FeatureVector> batch; stream.next(batch); ) {
+      if (batch.size() != 1) return -1;
+      if (batch.frameInfo() != data_set.frameInfo()) return -1;
+      if (batch[0] != data_set[index++]) return -1;
+    }
+    if (index != data_set.size()) return -1;
+  }
+
   return 0;
 }
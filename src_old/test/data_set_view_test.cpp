@@ -0,0 +1,65 @@
+#include "data/data_set_view.hpp"
+#include "data/feature_vector_set.hpp"
+
+#include <random>
+
+namespace td = track_select::data;
+namespace ts = track_select;
+int main(int argc, char** argv) {
+  std::shared_ptr<td::FeatureVectorSet> set(new td::FeatureVectorSet("Dummy Set"));
+  for (unsigned int i = 0; i < 10; i++) {
+    td::FeatureVector point(ts::Vector::Constant(3, i));
+    point.setCategory(i % 2);
+    *set << point;
+  }
+
+  td::FeatureVectorSetView view(set);
+  if (view.size() != 10) return -1;
+  if (view.dim() != 3) return -1;
+  for (unsigned int i = 0; i < view.size(); i++)
+    if (&view[i] != &(*set)[i]) return -1;
+
+  std::mt19937 generator(0);
+  td::FeatureVectorSetView shuffled(view);
+  shuffled.shuffle(generator);
+  if (view.indexes()[3] != 3) return -1;
+  std::vector<unsigned int> sorted = shuffled.indexes();
+  std::sort(sorted.begin(), sorted.end());
+  if (sorted != view.indexes()) return -1;
+
+  unsigned int i = 0;
+  for (auto& point : shuffled)
+    if (&point != &shuffled[i++]) return -1;
+  if (shuffled.end() - shuffled.begin() != 10) return -1;
+
+  td::FeatureVectorSetView part = shuffled.subset(2, 5);
+  if (part.size() != 3) return -1;
+  if (&part[0] != &shuffled[2]) return -1;
+
+  td::FeatureVectorSetView odd = view.category(1);
+  if (odd.size() != 5) return -1;
+  for (auto& point : odd)
+    if (point.category() != 1) return -1;
+
+  auto folds = shuffled.fold(1, 3);
+  if (folds.first.size() != 7 || folds.second.size() != 3) return -1;
+  if (&folds.second[0] != &shuffled[3]) return -1;
+  if (&folds.first[3] != &shuffled[6]) return -1;
+
+  td::FeatureVectorSetView::zero_class_check(view);
+  try {
+    td::FeatureVectorSetView::zero_class_check(odd);
+    return -1;
+  } catch (td::ErrorNullClass e) {}
+
+  td::FeatureVectorSet copy = part.copy();
+  if (copy.size() != 3) return -1;
+  if (copy.info() != set->info()) return -1;
+  for (unsigned int i = 0; i < copy.size(); i++)
+    if (copy[i] != part[i]) return -1;
+
+  td::FeatureVectorSetView borrowed(copy);
+  if (&borrowed[1] != &copy[1]) return -1;
+
+  return 0;
+}
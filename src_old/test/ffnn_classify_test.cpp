@@ -0,0 +1,62 @@
+#include "objective/ffnn_classify.hpp"
+
+#include <cmath>
+
+namespace ts = track_select;
+namespace td = track_select::data;
+namespace to = track_select::objective;
+
+/* The class probabilities of one point from the network of the params */
+static ts::Vector naiveProbabilities(const ts::nn::FeedForwardNetwork& network,
+                                     const ts::Vector& point) {
+  ts::Vector o = network(point).array().exp().matrix();
+  return o / o.sum();
+}
+
+static bool sameProbabilities(const to::FFNNClassify& obj,
+                              const ts::Vector& params,
+                              const td::FeatureVectorSet& set,
+                              ts::real tolerance) {
+  ts::nn::FeedForwardNetwork network = obj.buildFromParams(params);
+  ts::Matrix probabilities = obj.classProbabilities(params);
+
+  if (probabilities.rows() != obj.categoriesCount()) return false;
+  if (probabilities.cols() != set.size()) return false;
+  for (unsigned int i = 0; i < set.size(); i++) {
+    ts::Vector expected = naiveProbabilities(network, set[i]);
+    if ((expected - probabilities.col(i)).cwiseAbs().maxCoeff() > tolerance)
+      return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  /* More than two blocks of points, the last one partial */
+  td::FeatureVectorSet set("Dummy Set");
+  for (unsigned int i = 0; i < 1100; i++) {
+    td::FeatureVector point(ts::Vector(ts::Vector::Random(6)));
+    point.setCategory(i % 3);
+    set << point;
+  }
+
+  to::FFNNClassify obj(1, 5, to::Classify::LOGPROB, set);
+  if (obj.categoriesCount() != 3) return -1;
+
+  ts::Vector params = ts::Vector::Random(to::FFNNClassify::calcParamsCount(6, 5, 3));
+  if (!sameProbabilities(obj, params, set, 1e-12)) return -1;
+
+  obj.setSinglePrecision(true);
+  if (!obj.singlePrecision()) return -1;
+  if (!sameProbabilities(obj, params, set, 1e-5)) return -1;
+
+  /* A clone shares the float points */
+  to::FFNNClassify clone(obj);
+  if (!clone.singlePrecision()) return -1;
+  if (!sameProbabilities(clone, params, set, 1e-5)) return -1;
+
+  obj.setSinglePrecision(false);
+  if (obj.singlePrecision()) return -1;
+  if (!sameProbabilities(obj, params, set, 1e-12)) return -1;
+
+  return 0;
+}
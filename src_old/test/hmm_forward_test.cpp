@@ -0,0 +1,199 @@
+#include "objective/hmm_forward.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace ts = track_select;
+namespace td = track_select::data;
+namespace to = track_select::objective;
+
+/* std::exp, which unlike the vectorised exp of Eigen gives 0 for -inf */
+static ts::real probability(ts::real log_probability) {
+  return std::exp(log_probability);
+}
+
+/* The textbook forward algorithm on one sequence, without scaling */
+static ts::real naiveLogLikelihood(const ts::Vector& pi, const ts::Matrix& tr,
+                                   const ts::Matrix& log_emissions,
+                                   const td::SequenceArena& arena,
+                                   unsigned int seq) {
+  unsigned int offset = arena.offsets()[seq];
+  if (!arena.length(seq)) return 0;
+
+  ts::Vector alpha = pi.cwiseProduct(
+    log_emissions.col(offset).unaryExpr(&probability));
+  for (unsigned int t = 1; t < arena.length(seq); t++)
+    alpha = (tr.transpose() * alpha).cwiseProduct(
+      log_emissions.col(offset + t).unaryExpr(&probability));
+
+  return std::log(alpha.sum());
+}
+
+static bool sameLogLikelihood(const to::HMMForward& forward,
+                              const ts::Vector& pi, const ts::Matrix& tr,
+                              const ts::Matrix& log_emissions) {
+  ts::Vector log_likelihood = forward.logLikelihood(pi, tr, log_emissions);
+  if (log_likelihood.size() != forward.arena().size()) return false;
+
+  for (unsigned int s = 0; s < forward.arena().size(); s++) {
+    ts::real expected = naiveLogLikelihood(pi, tr, log_emissions,
+                                           forward.arena(), s);
+    if (std::isinf(expected) || std::isinf(log_likelihood(s))) {
+      if (expected != log_likelihood(s)) return false;
+    } else if (std::abs(expected - log_likelihood(s)) > 1e-9) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const unsigned int States = 3;
+  const ts::real Infinity = std::numeric_limits<ts::real>::infinity();
+
+  /* More sequences than lanes, of lengths 0 to 12, so lanes end at
+   * different steps */
+  td::SequenceSet set("Dummy Set");
+  for (unsigned int i = 0; i < 150; i++) {
+    td::Sequence seq(2);
+    for (unsigned int f = 0; f < (i * 7) % 13; f++)
+      seq << ts::Vector::Random(2);
+    set << seq;
+  }
+  std::shared_ptr<const td::SequenceArena> arena(new td::SequenceArena(set));
+  to::HMMForward forward(arena, 16);
+
+  ts::Vector pi = ts::Vector::Random(States).cwiseAbs();
+  pi /= pi.sum();
+  ts::Matrix tr = ts::Matrix::Random(States, States).cwiseAbs();
+  for (unsigned int i = 0; i < States; i++)
+    tr.row(i) /= tr.row(i).sum();
+
+  /* Log emissions given directly, some frames impossible under a state or
+   * under all of them */
+  ts::Matrix log_emissions =
+    ts::Matrix::Random(States, arena->frames().cols()).array() - 1;
+  for (unsigned int f = 0; f < log_emissions.cols(); f += 5)
+    log_emissions(f % States, f) = -Infinity;
+  log_emissions.col(arena->offsets()[1]).setConstant(-Infinity);
+  if (!sameLogLikelihood(forward, pi, tr, log_emissions)) return -1;
+  if (!std::isinf(forward.logLikelihood(pi, tr, log_emissions)(1))) return -1;
+  if (forward.logLikelihood(pi, tr, log_emissions)(0) != 0) return -1;
+
+  /* A network per state */
+  std::vector<std::vector<ts::nn::FeedForwardNetwork::layer>> networks;
+  to::ParamLayout layout;
+  std::vector<unsigned int> blocks;
+  for (unsigned int s = 0; s < States; s++) {
+    blocks.push_back(layout.add(4, 2));
+    blocks.push_back(layout.add(4));
+    blocks.push_back(layout.add(1, 4));
+    blocks.push_back(layout.add(1));
+  }
+  ts::Vector params = ts::Vector::Random(layout.size());
+
+  std::vector<to::HMMForward::NNEmissionView> views;
+  for (unsigned int s = 0; s < States; s++) {
+    const unsigned int* b = &blocks[4 * s];
+    views.push_back({layout.matrix(params, b[0]), layout.vector(params, b[1]),
+                     layout.matrix(params, b[2]), layout.vector(params, b[3])});
+    networks.push_back({
+        std::make_tuple(ts::Matrix(layout.matrix(params, b[0])),
+                        ts::Vector(layout.vector(params, b[1])),
+                        ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
+        std::make_tuple(ts::Matrix(layout.matrix(params, b[2])),
+                        ts::Vector(layout.vector(params, b[3])),
+                        ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
+  }
+
+  ts::Matrix from_networks =
+    to::HMMForward::logEmissions(networks, arena->frames());
+  ts::Matrix from_views = to::HMMForward::logEmissions(views, arena->frames());
+  if ((from_networks - from_views).cwiseAbs().maxCoeff() > 1e-12) return -1;
+  if (!sameLogLikelihood(forward, pi, tr, from_networks)) return -1;
+
+  /* The emission is the sigmoid output of the network */
+  ts::Vector frame = arena->frames().col(7);
+  ts::Vector hidden = (1 + (-(std::get<0>(networks[1][0]) * frame +
+                              std::get<1>(networks[1][0])).array()).exp())
+    .inverse().matrix();
+  ts::real output = (std::get<0>(networks[1][1]) * hidden +
+                     std::get<1>(networks[1][1]))(0);
+  if (std::abs(std::log(1 / (1 + std::exp(-output))) - from_networks(1, 7))
+      > 1e-12) return -1;
+
+  ts::Vector from_template = forward.logLikelihood(pi, tr, views);
+  if (from_template != forward.logLikelihood(pi, tr, from_views)) return -1;
+
+  /* A linear output is not a probability */
+  std::get<2>(networks[2][1]) = ts::nn::FeedForwardNetwork::LINEAR_ACTIVATION;
+  try {
+    to::HMMForward::logEmissions(networks, arena->frames());
+    return -1;
+  } catch (ts::hmm::ErrorHMM e) {}
+
+  /* A gaussian per state */
+  std::vector<std::tuple<ts::Vector, ts::Matrix>> gaussians;
+  for (unsigned int s = 0; s < States; s++) {
+    ts::Matrix a = ts::Matrix::Random(2, 2);
+    gaussians.push_back(std::make_tuple(
+                          ts::Vector(ts::Vector::Random(2)),
+                          ts::Matrix(a * a.transpose() +
+                                     0.1 * ts::Matrix::Identity(2, 2))));
+  }
+
+  ts::Matrix from_gaussians =
+    to::HMMForward::logEmissions(gaussians, arena->frames());
+  if (from_gaussians.rows() != States ||
+      from_gaussians.cols() != arena->frames().cols()) return -1;
+  for (unsigned int s = 0; s < States; s++) {
+    const ts::Matrix& cov = std::get<1>(gaussians[s]);
+    for (unsigned int f = 0; f < arena->frames().cols(); f++) {
+      ts::Vector d = arena->frames().col(f) - std::get<0>(gaussians[s]);
+      ts::real density = std::exp(-0.5 * d.dot(cov.inverse() * d)) /
+        (2 * M_PI * std::sqrt(cov.determinant()));
+      if (std::abs(std::log(density) - from_gaussians(s, f)) > 1e-9)
+        return -1;
+    }
+  }
+  if (!sameLogLikelihood(forward, pi, tr, from_gaussians)) return -1;
+  if (forward.logLikelihood(pi, tr, gaussians) !=
+      forward.logLikelihood(pi, tr, from_gaussians)) return -1;
+
+  std::get<1>(gaussians[1]) = -ts::Matrix::Identity(2, 2);
+  try {
+    to::HMMForward::logEmissions(gaussians, arena->frames());
+    return -1;
+  } catch (ts::hmm::ErrorHMM e) {}
+
+  /* Symbols 0 to 3 looked up in a table of 3 symbols, one with probability
+   * 0 under a state */
+  td::SequenceSet symbols("Dummy Set");
+  for (unsigned int i = 0; i < 40; i++) {
+    td::Sequence seq(1);
+    for (unsigned int f = 0; f < i % 9; f++)
+      seq << ts::Vector::Constant(1, (i + f) % 4);
+    symbols << seq;
+  }
+  std::shared_ptr<const td::SequenceArena>
+    symbol_arena(new td::SequenceArena(symbols));
+  to::HMMForward symbol_forward(symbol_arena, 16);
+
+  ts::Matrix table = ts::Matrix::Random(3, States).cwiseAbs();
+  table(2, 0) = 0;
+  for (unsigned int s = 0; s < States; s++)
+    table.col(s) /= table.col(s).sum();
+
+  ts::Matrix from_table =
+    to::HMMForward::logEmissions(table, symbol_arena->frames());
+  for (unsigned int f = 0; f < symbol_arena->frames().cols(); f++) {
+    unsigned int symbol = symbol_arena->frames()(0, f);
+    for (unsigned int s = 0; s < States; s++) {
+      ts::real expected = symbol < 3 ? std::log(table(symbol, s)) : -Infinity;
+      if (from_table(s, f) != expected) return -1;
+    }
+  }
+  if (!sameLogLikelihood(symbol_forward, pi, tr, from_table)) return -1;
+
+  return 0;
+}
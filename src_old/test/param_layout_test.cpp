@@ -0,0 +1,149 @@
+#include "objective/param_layout.hpp"
+#include "objective/ffnn_classify.hpp"
+#include "objective/hmm.hpp"
+
+namespace ts = track_select;
+namespace td = track_select::data;
+namespace to = track_select::objective;
+
+/* The networks as the params were read one value at a time before the
+ * layout, weights row after row */
+static ts::nn::FeedForwardNetwork readNetwork(const ts::Vector& params,
+                                              unsigned int input_dim,
+                                              unsigned int hidden_units,
+                                              unsigned int categories) {
+  unsigned int index = 0;
+  ts::Matrix hidden_weights(hidden_units, input_dim);
+  ts::Vector hidden_biases(hidden_units);
+  ts::Matrix output_weights(categories, hidden_units);
+  ts::Vector output_biases(categories);
+
+  for (unsigned int i = 0; i < hidden_units; i++)
+    for (unsigned int j = 0; j < input_dim; j++)
+      hidden_weights(i, j) = params(index++);
+  for (unsigned int i = 0; i < hidden_units; i++)
+    hidden_biases(i) = params(index++);
+  for (unsigned int i = 0; i < categories; i++)
+    for (unsigned int j = 0; j < hidden_units; j++)
+      output_weights(i, j) = params(index++);
+  for (unsigned int i = 0; i < categories; i++)
+    output_biases(i) = params(index++);
+
+  return ts::nn::FeedForwardNetwork({
+      std::make_tuple(hidden_weights, hidden_biases,
+                      ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
+        std::make_tuple(output_weights, output_biases,
+                        ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
+}
+
+static std::vector<to::HMM::Model> readModels(const ts::Vector& params,
+                                              unsigned int input_dim,
+                                              unsigned int hidden_units,
+                                              unsigned int states,
+                                              unsigned int categories) {
+  std::vector<to::HMM::Model> res(categories);
+  unsigned int index = 0;
+
+  for (auto& model : res) {
+    model.pi.resize(states);
+    for (unsigned int s = 0; s < states; s++)
+      model.pi(s) = params(index++);
+
+    model.tr.resize(states, states);
+    for (unsigned int s1 = 0; s1 < states; s1++)
+      for (unsigned int s2 = 0; s2 < states; s2++)
+        model.tr(s1, s2) = params(index++);
+    ts::hmm::NNHMM::normalize(model.pi, model.tr);
+
+    for (unsigned int s = 0; s < states; s++) {
+      ts::Vector hidden_biases(hidden_units);
+      ts::Matrix hidden_weights(hidden_units, input_dim);
+      ts::Vector output_bias(1);
+      ts::Matrix output_weights(1, hidden_units);
+
+      for (unsigned int hu = 0; hu < hidden_units; hu++)
+        hidden_biases(hu) = params(index++);
+      for (unsigned int hu = 0; hu < hidden_units; hu++)
+        for (unsigned int i = 0; i < input_dim; i++)
+          hidden_weights(hu, i) = params(index++);
+      output_bias(0) = params(index++);
+      for (unsigned int hu = 0; hu < hidden_units; hu++)
+        output_weights(0, hu) = params(index++);
+
+      model.em.push_back({
+          std::make_tuple(hidden_weights, hidden_biases,
+                          ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION),
+            std::make_tuple(output_weights, output_bias,
+                            ts::nn::FeedForwardNetwork::SIGMOID_ACTIVATION)});
+    }
+  }
+
+  return res;
+}
+
+int main(int argc, char** argv) {
+  to::ParamLayout layout;
+  unsigned int matrix = layout.add(2, 3);
+  unsigned int vector = layout.add(4);
+  if (layout.size() != 10 || layout.offset(vector) != 6) return -1;
+
+  ts::Vector params(10);
+  for (unsigned int i = 0; i < 10; i++) params(i) = i;
+  if (layout.matrix(params, matrix)(1, 0) != 3) return -1;
+  if (layout.vector(params, vector)(0) != 6) return -1;
+  try {
+    layout.vector(ts::Vector::Zero(9), vector);
+    return -1;
+  } catch (ts::ErrorInconsistentDim e) {}
+
+  /* FFNNClassify reads the params in the order of the networks it built
+   * before the layout */
+  td::FeatureVectorSet vectors("Dummy Set");
+  for (unsigned int i = 0; i < 30; i++) {
+    td::FeatureVector point(ts::Vector(ts::Vector::Random(4)));
+    point.setCategory(i % 3);
+    vectors << point;
+  }
+
+  to::FFNNClassify ffnn(1, 5, to::Classify::LOGPROB, vectors);
+  if (ffnn.layout().size() != to::FFNNClassify::calcParamsCount(4, 5, 3))
+    return -1;
+
+  params = ts::Vector::Random(ffnn.layout().size());
+  ts::nn::FeedForwardNetwork network = ffnn.buildFromParams(params);
+  ts::nn::FeedForwardNetwork expected = readNetwork(params, 4, 5, 3);
+  for (unsigned int i = 0; i < vectors.size(); i++)
+    if (network(vectors[i]) != expected(vectors[i])) return -1;
+
+  /* And so does HMM */
+  td::SequenceSet sequences("Dummy Set");
+  for (unsigned int i = 0; i < 10; i++) {
+    td::Sequence seq(3);
+    for (unsigned int f = 0; f < 4; f++)
+      seq << ts::Vector::Random(3);
+    seq.setCategory(i % 2);
+    sequences << seq;
+  }
+
+  to::HMM hmm(1, 4, 2, to::Classify::LOGPROB, sequences);
+  params = ts::Vector::Random(hmm.layout().size());
+  std::vector<to::HMM::Model> models = hmm.modelsFromParams(params);
+  std::vector<to::HMM::Model> expected_models = readModels(params, 3, 4, 2, 2);
+  if (models.size() != expected_models.size()) return -1;
+
+  for (unsigned int c = 0; c < models.size(); c++) {
+    if (models[c].pi != expected_models[c].pi) return -1;
+    if (models[c].tr != expected_models[c].tr) return -1;
+    if (models[c].em.size() != expected_models[c].em.size()) return -1;
+
+    for (unsigned int s = 0; s < models[c].em.size(); s++)
+      for (unsigned int l = 0; l < 2; l++) {
+        const auto& layer = models[c].em[s][l];
+        const auto& expected_layer = expected_models[c].em[s][l];
+        if (std::get<0>(layer) != std::get<0>(expected_layer)) return -1;
+        if (std::get<1>(layer) != std::get<1>(expected_layer)) return -1;
+      }
+  }
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "data/sequence_arena.hpp"
+
+namespace td = track_select::data;
+namespace ts = track_select;
+int main(int argc, char** argv) {
+  td::SequenceArena empty;
+  if (empty.size() != 0) return -1;
+
+  td::SequenceSet set;
+  for (unsigned int i = 0; i < 10; i++) {
+    td::Sequence seq;
+    for (unsigned int f = 0; f < i + 1; f++)
+      seq << ts::Vector::Random(3);
+    seq.setCategory(i % 2);
+    seq.setSourceTrackId(i);
+    seq.setSourceDataSet(i < 5 ? "first" : "second");
+    set << seq;
+  }
+
+  td::Sequence no_attributes;
+  no_attributes << ts::Vector::Random(3);
+  set << no_attributes;
+
+  td::SequenceArena arena(set);
+  if (arena.size() != set.size()) return -1;
+  if (arena.dim() != 3) return -1;
+  if (arena.offsets().size() != set.size() + 1) return -1;
+  if (arena.frames().cols() != 56) return -1;
+  if (arena.sourceDataSets().size() != 2) return -1;
+
+  for (unsigned int i = 0; i < 10; i++) {
+    if (arena.length(i) != set[i].size()) return -1;
+    if (arena.sequence(i) != set[i].matrix()) return -1;
+    if (arena.end(i) - arena.begin(i) != set[i].size()) return -1;
+    if (arena.category(i) != set[i].category()) return -1;
+    if (arena.sourceTrackId(i) != set[i].sourceTrackId()) return -1;
+    if (arena.sourceDataSet(i) != set[i].sourceDataSet()) return -1;
+    if (!(arena.at(i) == set[i])) return -1;
+
+    /* Indexing gives views that outlive the expression */
+    auto it = arena.begin(i);
+    for (unsigned int f = 0; f < arena.length(i); f++) {
+      ts::Vector frame = it[f];
+      if (frame != arena.sequence(i).col(f)) return -1;
+    }
+  }
+
+  if (arena.sourceDataSetIndex(0) != arena.sourceDataSetIndex(4)) return -1;
+  if (arena.sourceDataSetIndex(0) == arena.sourceDataSetIndex(5)) return -1;
+
+  try {
+    arena.category(10);
+    return -1;
+  } catch (ts::ErrorAttributeNotSet e) {}
+  if (arena.sourceDataSetIndex(10) != td::SequenceArena::NoSourceDataSet)
+    return -1;
+
+  std::vector<td::SequenceArena> parts(3);
+  parts[0] = td::SequenceArena(set);
+  parts[2] = td::SequenceArena(set);
+  td::SequenceArena spliced(parts);
+  if (spliced.size() != 2 * set.size()) return -1;
+  if (spliced.frames().cols() != 112) return -1;
+  if (spliced.sourceDataSets().size() != 2) return -1;
+  for (unsigned int i = 0; i < set.size(); i++) {
+    if (spliced.sequence(set.size() + i) != set[i].matrix()) return -1;
+    if (spliced.sourceDataSetIndex(set.size() + i) !=
+        arena.sourceDataSetIndex(i)) return -1;
+  }
+
+  return 0;
+}
@@ -108,6 +108,24 @@ int main(int argc, char** argv) {
   if (clone == seq) return -1;
 
 
+  td::Sequence long_seq;
+  std::vector<ts::Vector> frames;
+  for (unsigned int i = 0; i < 100; i++) {
+    frames.push_back(ts::Vector::Random(3));
+    long_seq << frames.back();
+  }
+  if (long_seq.size() != 100) return -1;
+  if (long_seq.end() - long_seq.begin() != 100) return -1;
+  if (long_seq.matrix().cols() != 100) return -1;
+
+  unsigned int f_index = 0;
+  for (auto& f : long_seq)
+    if (f != frames[f_index++]) return -1;
+
+  for (auto& f : long_seq) f *= 2;
+  for (unsigned int i = 0; i < long_seq.size(); i++)
+    if (long_seq[i] != 2 * frames[i]) return -1;
+
   td::Sequence clone1 = seq;
   if (!(clone1 == seq)) return -1;
 
@@ -0,0 +1,75 @@
+#include "data/string_interner.hpp"
+#include "data/feature_vector.hpp"
+
+#include <thread>
+#include <memory>
+#include <new>
+#include <vector>
+#include <sstream>
+
+namespace td = track_select::data;
+namespace ts = track_select;
+int main(int argc, char** argv) {
+  td::StringInterner table;
+  if (table.size() != 0) return -1;
+
+  td::StringInterner::id_type first = table.intern("first");
+  td::StringInterner::id_type second = table.intern("second");
+  if (first == second) return -1;
+  if (table.intern("first") != first) return -1;
+  if (table.str(first) != "first") return -1;
+  if (table.str(second) != "second") return -1;
+  if (table.size() != 2) return -1;
+
+  try {
+    table.str(2);
+    return -1;
+  } catch (std::out_of_range e) {}
+
+  /* More strings than a chunk, interned from several threads at once */
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < 4; t++)
+    threads.push_back(std::thread([&table]() {
+          for (unsigned int i = 0; i < 3000; i++) {
+            std::stringstream ss;
+            ss << "name-" << i;
+            if (table.str(table.intern(ss.str())) != ss.str())
+              throw std::runtime_error("mismatch");
+          }
+        }));
+  for (auto& t : threads) t.join();
+
+  if (table.size() != 3002) return -1;
+  for (unsigned int i = 0; i < 3000; i++) {
+    std::stringstream ss;
+    ss << "name-" << i;
+    if (table.str(table.intern(ss.str())) != ss.str()) return -1;
+  }
+
+  /* A table built where another one was does not see its strings */
+  std::unique_ptr<td::StringInterner> replaced(new td::StringInterner());
+  void* at = replaced.get();
+  if (replaced->intern("shared") != 0) return -1;
+  replaced->~StringInterner();
+  new (at) td::StringInterner();
+  if (replaced->intern("shared") != 0) return -1;
+  if (replaced->size() != 1 || replaced->str(0) != "shared") return -1;
+
+  /* Points of the same source share the id */
+  td::FeatureVector a(ts::Vector::Zero(2));
+  td::FeatureVector b(ts::Vector::Zero(2));
+  a.setSourceDataSet("project");
+  b.setSourceDataSet(std::string("proj") + "ect");
+  if (a.sourceDataSetId() != b.sourceDataSetId()) return -1;
+  if (!(a == b)) return -1;
+  if (a.sourceDataSet() != "project") return -1;
+
+  b.setSourceDataSet("other");
+  if (a.sourceDataSetId() == b.sourceDataSetId()) return -1;
+  if (a == b) return -1;
+
+  b.setSourceDataSetId(a.sourceDataSetId());
+  if (b.sourceDataSet() != "project") return -1;
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include "parallel/thread_pool.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace tp = track_select::parallel;
+int main(int argc, char** argv) {
+  tp::ThreadPool pool(4);
+  if (pool.size() != 4) return -1;
+
+  /* Every iteration runs once, whatever the chunk */
+  for (unsigned int chunk : {0u, 1u, 7u, 1000u}) {
+    std::vector<std::atomic<unsigned int>> calls(1000);
+    for (auto& c : calls) c = 0;
+    pool.parallelFor(0, calls.size(), chunk, [&](unsigned int i) {
+        calls[i]++;
+      });
+    for (auto& c : calls)
+      if (c != 1) return -1;
+  }
+
+  std::atomic<unsigned int> count(0);
+  pool.parallelFor(5, 5, 0, [&](unsigned int) { count++; });
+  pool.parallelFor(10, 20, 3, [&](unsigned int i) {
+      if (i >= 10 && i < 20) count++;
+    });
+  if (count != 10) return -1;
+
+  /* Nested loops on the same pool, more outer iterations than threads */
+  std::vector<std::atomic<unsigned int>> sums(16);
+  for (auto& s : sums) s = 0;
+  pool.parallelFor(0, sums.size(), 1, [&](unsigned int i) {
+      pool.parallelFor(0, 100, 0, [&](unsigned int j) {
+          sums[i] += j;
+        });
+    });
+  for (auto& s : sums)
+    if (s != 4950) return -1;
+
+  /* The first exception is thrown once all chunks ran */
+  count = 0;
+  try {
+    pool.parallelFor(0, 100, 1, [&](unsigned int i) {
+        count++;
+        if (i == 50) throw std::runtime_error("fail");
+      });
+    return -1;
+  } catch (std::runtime_error e) {}
+  if (count != 100) return -1;
+
+  /* Without workers the caller runs the loop */
+  tp::ThreadPool single(1);
+  if (single.size() != 1) return -1;
+  count = 0;
+  single.parallelFor(0, 10, 0, [&](unsigned int) { count++; });
+  if (count != 10) return -1;
+
+  if (tp::ThreadPool::global().size() < 1) return -1;
+
+  return 0;
+}
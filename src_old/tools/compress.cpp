@@ -14,6 +14,17 @@ namespace ts = track_select;
 namespace po = boost::program_options;
 
 namespace track_select {
+  /* The point transformed by reduce with the attributes of the original */
+  data::FeatureVector reducePoint(const nn::FeedForwardNetwork& reduce,
+                                  const data::FeatureVector& point) {
+    data::FeatureVector new_point(reduce(point));
+    new_point.setSourceDataSet(point.sourceDataSet());
+    new_point.setSourceTrackId(point.sourceTrackId());
+    new_point.setSourceRange(point.sourceRange());
+    new_point.setCategory(point.category());
+    return new_point;
+  }
+
   std::tuple<data::FeatureVectorSet, nn::FeedForwardNetwork>
   extract_scores(const data::FeatureVectorSet& src,
                  std::vector<std::string> new_scores,
@@ -58,31 +69,21 @@ namespace track_select {
                               biases,
                               nn::FeedForwardNetwork::LINEAR_ACTIVATION)});
 
-    for (auto& point : src) {
-      ts::data::FeatureVector new_point(reduce(point));
-      new_point.setSourceDataSet(point.sourceDataSet());
-      new_point.setSourceTrackId(point.sourceTrackId());
-      new_point.setSourceRange(point.sourceRange());
-      new_point.setCategory(point.category());
-
-      reduced << new_point;
-    }
+    for (auto& point : src)
+      reduced << reducePoint(reduce, point);
 
     return std::make_tuple(reduced, reduce);
   }
 
-  std::tuple<data::FeatureVectorSet, nn::FeedForwardNetwork>
-  pca(const data::FeatureVectorSet& src, real var) {
-    Matrix data(src.dim(), src.size());
-
-    for (unsigned int i = 0; i < src.size(); i++) {
-      data.col(i) = src[i];
-    }
-    Vector biases = - data.rowwise().mean();
-
-    data = data.colwise() + biases;
+  /* The projection onto the principal components capturing var of the
+   * variance and its decoder. biases is minus the mean of the data and
+   * scatter the scatter matrix of the centred data.
+   */
+  std::tuple<nn::FeedForwardNetwork, nn::FeedForwardNetwork>
+  pcaProjection(const Vector& biases, const Matrix& scatter, real var) {
+    unsigned int dim = biases.rows();
 
-    Eigen::EigenSolver<Matrix> solver(data * data.transpose());
+    Eigen::EigenSolver<Matrix> solver(scatter);
     Matrix evals = solver.eigenvalues().real();
     Matrix evects = solver.eigenvectors().real();
 
@@ -93,9 +94,9 @@ namespace track_select {
       sum += evals(count++);
     }
 
-    Matrix weights(count , src.dim());
+    Matrix weights(count , dim);
     for (unsigned int i = 0; i < count; i++)
-      for (unsigned int j = 0; j < src.dim(); j++)
+      for (unsigned int j = 0; j < dim; j++)
         weights(i, j) = evects(j, i);
 
     nn::FeedForwardNetwork reduce({
@@ -107,11 +108,33 @@ namespace track_select {
                         weights.transpose() * weights * biases,
                         nn::FeedForwardNetwork::LINEAR_ACTIVATION)});
 
+    return std::make_tuple(reduce, decoder);
+  }
+
+  data::FeatureVectorSet pcaReduced(const data::FeatureVectorSet& src) {
     std::stringstream reduced_info;
     reduced_info << src.info()
                  << " Reduced by PCA. Extracted from data set with id "
                  << src.id() << ".";
-    data::FeatureVectorSet reduced(funcs::splitToLines80(reduced_info.str()));
+    return data::FeatureVectorSet(funcs::splitToLines80(reduced_info.str()));
+  }
+
+  std::tuple<data::FeatureVectorSet, nn::FeedForwardNetwork>
+  pca(const data::FeatureVectorSet& src, real var) {
+    Matrix data(src.dim(), src.size());
+
+    for (unsigned int i = 0; i < src.size(); i++) {
+      data.col(i) = src[i];
+    }
+    Vector biases = - data.rowwise().mean();
+
+    data = data.colwise() + biases;
+
+    nn::FeedForwardNetwork reduce;
+    nn::FeedForwardNetwork decoder;
+    std::tie(reduce, decoder) = pcaProjection(biases, data * data.transpose(), var);
+
+    data::FeatureVectorSet reduced = pcaReduced(src);
 
     real err = 0;
     for (auto& p : src)
@@ -119,17 +142,82 @@ namespace track_select {
     err /= src.size();
     std::cout << "Reconstruction error " << err << std::endl;
 
-    for (auto& point : src) {
-      ts::data::FeatureVector new_point(reduce(point));
-      new_point.setSourceDataSet(point.sourceDataSet());
-      new_point.setSourceTrackId(point.sourceTrackId());
-      new_point.setSourceRange(point.sourceRange());
-      new_point.setCategory(point.category());
+    for (auto& point : src)
+      reduced << reducePoint(reduce, point);
 
-      reduced << new_point;
+    return std::make_tuple(reduced, reduce);
+  }
+
+  /* PCA of a stored set read through a cursor. The mean and scatter matrix
+   * are accumulated batch by batch, so only the header of the reduced set is
+   * returned; the points are written by storeStreamed.
+   */
+  std::tuple<data::FeatureVectorSet, nn::FeedForwardNetwork>
+  pcaStream(database_id id, pqxx::work& w, real var) {
+    data::DataSetStream<data::FeatureVector> stream =
+      data::FeatureVectorSet::stream(id, w);
+    unsigned int dim = stream.header().dim();
+
+    unsigned long count = 0;
+    Vector mean = Vector::Zero(dim);
+    Matrix scatter = Matrix::Zero(dim, dim);
+
+    /* Every batch is centred on its own mean and its scatter merged into
+     * the running one (Chan et al.), rather than taking n mean mean^T off
+     * the sum of x x^T, which cancels for points far from the origin */
+    for (data::FeatureVectorSet batch; stream.next(batch); ) {
+      if (!batch.size()) continue;
+
+      Matrix data(dim, batch.size());
+      for (unsigned int i = 0; i < batch.size(); i++)
+        data.col(i) = batch[i];
+
+      Vector batch_mean = data.rowwise().mean();
+      Vector delta = batch_mean - mean;
+      unsigned long total = count + batch.size();
+      data.colwise() -= batch_mean;
+
+      mean += delta * ((real)batch.size() / total);
+      scatter.noalias() += data * data.transpose();
+      scatter.noalias() += ((real)count * batch.size() / total) *
+        delta * delta.transpose();
+      count = total;
     }
 
-    return std::make_tuple(reduced, reduce);
+    if (!count) {
+      std::stringstream ss;
+      ss << "Data set with id " << id << " is empty";
+      throw std::runtime_error(ss.str());
+    }
+
+    nn::FeedForwardNetwork reduce;
+    nn::FeedForwardNetwork decoder;
+    std::tie(reduce, decoder) = pcaProjection(-mean, scatter, var);
+
+    return std::make_tuple(pcaReduced(stream.header()), reduce);
+  }
+
+  /* Stores reduced and, batch by batch, every point of the set with the
+   * given id transformed by reduce.
+   */
+  database_id storeStreamed(database_id id, data::FeatureVectorSet reduced,
+                            const nn::FeedForwardNetwork& reduce,
+                            pqxx::work& w, unsigned int data_type_size) {
+    data::DataSetStream<data::FeatureVector> stream =
+      data::FeatureVectorSet::stream(id, w);
+
+    if (!reduced.dimSet())
+      reduced.setDim(reduce(Vector::Zero(stream.header().dim())).rows());
+    database_id reduced_id = reduced.storeHeader(w);
+
+    for (data::FeatureVectorSet batch; stream.next(batch); ) {
+      data::FeatureVectorSet reduced_batch;
+      for (auto& point : batch)
+        reduced_batch << reducePoint(reduce, point);
+      reduced_batch.storePoints(reduced_id, w, data_type_size);
+    }
+
+    return reduced_id;
   }
 
 
@@ -223,15 +311,8 @@ namespace track_select {
     data::FeatureVectorSet reduced(funcs::splitToLines80(reduced_info.str()));
 
 
-    for (auto& point : src) {
-      ts::data::FeatureVector new_point(encoder(point));
-      new_point.setSourceDataSet(point.sourceDataSet());
-      new_point.setSourceTrackId(point.sourceTrackId());
-      new_point.setSourceRange(point.sourceRange());
-      new_point.setCategory(point.category());
-
-      reduced << new_point;
-    }
+    for (auto& point : src)
+      reduced << reducePoint(encoder, point);
 
     return std::make_tuple(reduced, encoder);
   }
@@ -250,7 +331,14 @@ int main(int argc, char** argv) {
     ("data-set-id", po::value<unsigned int>(), "Specify the id of the data set"
      " to be reduced.")
 
-    ("log", po::value<std::string>(), "log file");
+    ("log", po::value<std::string>(), "log file")
+
+    ("stream", "Read the data set through a cursor and store the reduced "
+     "points a batch at a time, for data sets larger than memory. Not "
+     "supported by auto-encoder.")
+
+    ("single-precision", "Store the values of the reduced points as float32, "
+     "which halves the stored data.");
 
 
   po::variables_map vm;
@@ -282,14 +370,26 @@ int main(int argc, char** argv) {
 
   std::string type = vm["type"].as<std::string>();
   unsigned int id = vm["data-set-id"].as<unsigned int>();
+  bool stream = vm.count("stream");
+  unsigned int data_type_size =
+    vm.count("single-precision") ? sizeof(float) : sizeof(ts::real);
   pqxx::connection conn;
   pqxx::work w(conn);
-  ts::data::FeatureVectorSet source
-    = ts::data::FeatureVectorSet::read(id, w);
+
+  /* Streaming keeps only the header of the source in memory */
+  ts::data::FeatureVectorSet source = stream ?
+    ts::data::FeatureVectorSet::stream(id, w).header() :
+    ts::data::FeatureVectorSet::read(id, w);
 
   std::tuple<ts::data::FeatureVectorSet, ts::nn::FeedForwardNetwork> res;
 
   if (type == "auto-encoder") {
+    if (stream) {
+      std::cerr << "Error: auto-encoder cannot be used with --stream"
+                << std::endl;
+      return -1;
+    }
+
     po::options_description ac_desc("Auto-Encoder");
 
     ac_desc.add_options()
@@ -354,7 +454,7 @@ int main(int argc, char** argv) {
       return -1;
     }
 
-    res = ts::pca(source, var);
+    res = stream ? ts::pcaStream(id, w, var) : ts::pca(source, var);
 
 
   } else if (type == "random") {
@@ -398,7 +498,10 @@ int main(int argc, char** argv) {
     return -1;
   }
 
-  unsigned int reduced_id = std::get<0>(res).store(w);
+  unsigned int reduced_id = stream ?
+    ts::storeStreamed(id, std::get<0>(res), std::get<1>(res), w,
+                      data_type_size) :
+    std::get<0>(res).store(w, data_type_size);
   std::cout << "Storing compressed data set with id "
             << reduced_id << std::endl;
   std::stringstream fname;
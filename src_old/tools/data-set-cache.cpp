@@ -0,0 +1,43 @@
+#include <iostream>
+#include <sstream>
+#include <track-select>
+#include "data/data_set_cache.hpp"
+
+namespace ts = track_select;
+
+int main(int argc, char ** argv) {
+  std::unique_ptr<ts::data::DataSetCache> cache =
+    ts::data::DataSetCache::fromEnvironment();
+
+  std::string command(argc > 1 ? argv[1] : "");
+  if (!cache || (command != "list" && command != "purge" &&
+                 command != "invalidate")) {
+    std::cerr << "Manages the local copies of stored data sets in the "
+              << "directory named by" << std::endl
+              << "TRACK_SELECT_CACHE." << std::endl << std::endl
+              << "Usage:" << std::endl
+              << "\tdata-set-cache list" << std::endl
+              << "\tdata-set-cache invalidate <data-set-id> ..." << std::endl
+              << "\tdata-set-cache purge" << std::endl;
+    return -1;
+  }
+
+  if (command == "list") {
+    for (ts::database_id id : cache->entries())
+      std::cout << id << " " << cache->path(id) << std::endl;
+  } else if (command == "purge") {
+    cache->purge();
+  } else {
+    for (int i = 2; i < argc; i++) {
+      std::stringstream ss(argv[i]);
+      ts::database_id id;
+      if (!(ss >> id)) {
+        std::cerr << "Invalid data set id " << argv[i] << std::endl;
+        return -1;
+      }
+      cache->invalidate(id);
+    }
+  }
+
+  return 0;
+}
@@ -29,7 +29,9 @@ int main(int argc, char** argv) {
      " same data set id")
 
     ("info", po::value<std::string>(), "Info about data set")
-    ("log", po::value<std::string>(), "log file");
+    ("log", po::value<std::string>(), "log file")
+    ("single-precision", "store the values of the imported data sets as "
+     "float32, which halves the stored data");
 
   po::variables_map vm;
   po::command_line_parser parser(argc, argv);
@@ -53,6 +55,8 @@ int main(int argc, char** argv) {
   std::string info = vm["info"].as<std::string>();
   std::string gdr_file = vm["global-drift-ranges"].as<std::string>();
   std::ofstream log(vm["log"].as<std::string>());
+  unsigned int data_type_size =
+    vm.count("single-precision") ? sizeof(float) : sizeof(ts::real);
 
 
   ts::import::ImportData reference;
@@ -93,18 +97,18 @@ int main(int argc, char** argv) {
     pqxx::connection conn;
     pqxx::work w(conn);
     log << "Storing image sequence set with ID "
-        << image.store(w) << std::endl;
+        << image.store(w, data_type_size) << std::endl;
 
     log << "Storing intensity sequences with ID "
-        << intensity.store(w) << std::endl;
+        << intensity.store(w, data_type_size) << std::endl;
 
     log << "Storing score vectors with ID "
-        << score.store(w) << std::endl;
+        << score.store(w, data_type_size) << std::endl;
 
     log << "Storing extrapolated image sequence set with ID "
-        << extrp_images.store(w) << std::endl;
+        << extrp_images.store(w, data_type_size) << std::endl;
     log << "Storing extrapolated intensity sequence set with ID "
-        << extrp_tracks.store(w) << std::endl;
+        << extrp_tracks.store(w, data_type_size) << std::endl;
 
     w.commit();
   } catch (std::runtime_error& e) {
@@ -1,19 +1,50 @@
 #include <iostream>
+#include <random>
 #include <track-select>
 #include "data/feature_vector_set.hpp"
 #include "data/sequence_set.hpp"
 #include "algorithm.hpp"
 
 namespace ts = track_select;
+
+/* Keeps a uniform random sample of size of the points offered so far */
+class Reservoir {
+  unsigned int size_;
+  unsigned long seen_;
+  std::vector<ts::data::FeatureVector> sample_;
+  std::mt19937 g_;
+
+public:
+  Reservoir(unsigned int size) : size_(size), seen_(0), g_(std::random_device()()) {}
+
+  void offer(const ts::data::FeatureVector& point) {
+    seen_++;
+    if (sample_.size() < size_) {
+      sample_.push_back(point);
+      return;
+    }
+
+    unsigned long k = std::uniform_int_distribution<unsigned long>(0, seen_ - 1)(g_);
+    if (k < size_) sample_[k] = point;
+  }
+
+  unsigned long seen() const { return seen_; }
+  std::vector<ts::data::FeatureVector>& sample() { return sample_; }
+};
+
 int main(int argc, char ** argv) {
 
-  if (argc != 4) {
+  bool stream = argc == 5 && std::string(argv[4]) == "--stream";
+  if (argc != 4 && !stream) {
     std::cerr << "Reduced the size of a labelled data set to specified positive"
               << std::endl
               << "and negative class size. " << std::endl << std::endl
               << "Usage:" << std::endl
               << "\treduce-data-size <data-set-id> <positive-size> "
-              << "<negative-size>" << std::endl;
+              << "<negative-size> [--stream]" << std::endl << std::endl
+              << "With --stream the data set is read through a cursor and "
+              << "only the" << std::endl
+              << "selected points are kept in memory." << std::endl;
     return -1;
   }
   unsigned int data_set_id;
@@ -27,36 +58,46 @@ int main(int argc, char ** argv) {
   pqxx::connection conn;
 
   ts::data::FeatureVectorSet source;
+  Reservoir Y(size_Y);
+  Reservoir N(size_N);
 
-  {
-    pqxx::work w(conn);
-    source = ts::data::FeatureVectorSet::read(data_set_id, w);
-  }
-
-  ts::data::FeatureVectorSet Y;
-  ts::data::FeatureVectorSet N;
-  for (auto& point : source) {
+  auto offer = [&](const ts::data::FeatureVector& point) {
     if (point.category() == ts::msmm::YES) {
-      Y << point;
+      Y.offer(point);
     } else if (point.category() == ts::msmm::NO) {
-      N << point;
+      N.offer(point);
     } else {
       std::stringstream ss;
       ss << "Unknown category " << point.category();
       throw std::runtime_error(ss.str());
     }
+  };
+
+  {
+    pqxx::work w(conn);
+    if (stream) {
+      ts::data::DataSetStream<ts::data::FeatureVector> points =
+        ts::data::FeatureVectorSet::stream(data_set_id, w);
+      source = points.header();
+
+      for (ts::data::FeatureVectorSet batch; points.next(batch); )
+        for (auto& point : batch) offer(point);
+    } else {
+      source = ts::data::FeatureVectorSet::read(data_set_id, w);
+      for (auto& point : source) offer(point);
+    }
   }
 
-  if (Y.size() < size_Y) {
+  if (Y.seen() < size_Y) {
     std::stringstream ss;
-    ss << "Size of yes class (" << Y.size()
+    ss << "Size of yes class (" << Y.seen()
        << ") is smaller than specified size: " << size_Y << std::endl;
     throw std::runtime_error(ss.str());
   }
 
-  if (N.size() < size_N) {
+  if (N.seen() < size_N) {
     std::stringstream ss;
-    ss << "Size of no class (" << N.size()
+    ss << "Size of no class (" << N.seen()
        << ") is smaller than specified size: " << size_N << std::endl;
     throw std::runtime_error(ss.str());
   }
@@ -69,11 +110,11 @@ int main(int argc, char ** argv) {
   if (source.frameInfoSet())
     reduced.setFrameInfo(source.frameInfo());
 
-  ts::algorithm::random_shuffle(Y.begin(), Y.end());
-  ts::algorithm::random_shuffle(N.begin(), N.end());
+  ts::algorithm::random_shuffle(Y.sample().begin(), Y.sample().end());
+  ts::algorithm::random_shuffle(N.sample().begin(), N.sample().end());
 
-  for (unsigned int i = 0; i < size_Y; i++) reduced << Y[i];
-  for (unsigned int i = 0; i < size_N; i++) reduced << N[i];
+  for (auto& point : Y.sample()) reduced << point;
+  for (auto& point : N.sample()) reduced << point;
 
   {
     pqxx::work w(conn);
@@ -1,6 +1,7 @@
 #include <boost/program_options.hpp>
 #include "data/feature_vector_set.hpp"
 #include "data/sequence_set.hpp"
+#include "data/data_set_join.hpp"
 #include "algorithm.hpp"
 
 namespace po = boost::program_options;
@@ -40,30 +41,126 @@ void whiten(unsigned int data_set_id) {
 }
 
 
-void divide_by_l1(unsigned int data_set_id, unsigned int ref, bool divide_all) {
+/* whiten reading the source through a cursor. The first pass collects the
+ * mean and variance, the second stores the transformed points a batch at a
+ * time.
+ */
+void whiten_stream(unsigned int data_set_id) {
   pqxx::connection conn;
   pqxx::work w(conn);
-  ts::data::FeatureVectorSet vect = ts::data::FeatureVectorSet::read(ref, w);
-  ts::data::SequenceSet seq = ts::data::SequenceSet::read(data_set_id, w);
 
+  ts::data::FeatureVectorSet source;
+  unsigned long count = 0;
+  ts::Vector mean;
+  ts::Vector deviations;
+  {
+    ts::data::DataSetStream<ts::data::FeatureVector> points =
+      ts::data::FeatureVectorSet::stream(data_set_id, w);
+    source = points.header();
+    mean = ts::Vector::Zero(source.dim());
+    deviations = ts::Vector::Zero(source.dim());
+
+    /* The squared deviations of a batch are taken about its own mean and
+     * merged with those of the batches before (Chan et al.). E[x^2] - mean^2
+     * cancels when the spread is small next to the mean. */
+    for (ts::data::FeatureVectorSet batch; points.next(batch); ) {
+      if (!batch.size()) continue;
+
+      ts::Matrix data(source.dim(), batch.size());
+      for (unsigned int i = 0; i < batch.size(); i++)
+        data.col(i) = batch[i];
+
+      ts::Vector batch_mean = data.rowwise().mean();
+      ts::Vector delta = batch_mean - mean;
+      unsigned long total = count + batch.size();
+
+      mean += delta * ((ts::real)batch.size() / total);
+      deviations += (data.colwise() - batch_mean).rowwise().squaredNorm() +
+        delta.cwiseAbs2() * ((ts::real)count * batch.size() / total);
+      count = total;
+    }
+  }
+
+  if (!count) {
+    std::stringstream ss;
+    ss << "Error: data set with id " << data_set_id << " is empty";
+    throw std::runtime_error(ss.str());
+  }
+
+  ts::Vector precision = (deviations / count).cwiseSqrt().cwiseInverse();
+
+  ts::Vector biases = -mean.cwiseProduct(precision);
+  ts::Matrix weights = ts::Matrix::Zero(source.dim(), source.dim());
+  weights.diagonal() = precision;
+
+  ts::nn::FeedForwardNetwork tr({
+      std::make_tuple(weights, biases,
+                      ts::nn::FeedForwardNetwork::LINEAR_ACTIVATION)});
+
+  std::stringstream info;
+  info << source.info()
+       << " Whitened. Extracted from data set with id " << source.id();
+
+  ts::data::FeatureVectorSet transformed(ts::funcs::splitToLines80(info.str()));
+  if (source.frameInfoSet())
+    transformed.setFrameInfo(source.frameInfo());
+  else
+    transformed.setDim(source.dim());
+
+  ts::database_id tr_id = transformed.storeHeader(w);
+
+  ts::data::DataSetStream<ts::data::FeatureVector> points =
+    ts::data::FeatureVectorSet::stream(data_set_id, w);
+  for (ts::data::FeatureVectorSet batch; points.next(batch); ) {
+    for (auto& point : batch) point = tr(point);
+    batch.storePoints(tr_id, w);
+  }
 
-  std::sort(vect.begin(), vect.end(),
-            [](const ts::data::FeatureVector& left,
-               const ts::data::FeatureVector& right) {
-              if (left.sourceDataSet() == right.sourceDataSet())
-                return left.sourceTrackId() < right.sourceTrackId();
+  std::cout << "Data set with id: " << tr_id << " stored" << std::endl;
+  w.commit();
 
-              return left.sourceDataSet() < right.sourceDataSet();
-            });
+  std::stringstream fname;
+  fname << "tr.whiten.id-" << tr_id << ".h5";
+  tr.writeHDF5(fname.str());
+}
 
-  std::sort(seq.begin(), seq.end(),
-            [](const ts::data::Sequence& left,
-               const ts::data::Sequence& right) {
-              if (left.sourceDataSet() == right.sourceDataSet())
-                return left.sourceTrackId() < right.sourceTrackId();
+/* For --strict: every sequence needs exactly one vector of its track in the
+ * reference set. The pairs of a sequence follow each other, so a sequence
+ * matching several vectors shows up as the same point twice in a row.
+ */
+void check_reference(const std::pair<ts::data::SequenceSetView,
+                                     ts::data::FeatureVectorSetView>& pairs,
+                     unsigned int sequences, unsigned int ref) {
+  unsigned int matched = 0;
+  for (unsigned int i = 0; i < pairs.first.size(); i++) {
+    if (i && &pairs.first[i] == &pairs.first[i - 1]) {
+      std::stringstream ss;
+      ss << "Error: reference set " << ref << " has track "
+         << pairs.first[i].sourceTrackId() << " of "
+         << pairs.first[i].sourceDataSet() << " more than once";
+      throw std::runtime_error(ss.str());
+    }
+    matched++;
+  }
+
+  if (matched != sequences) {
+    std::stringstream ss;
+    ss << "Error: " << sequences - matched << " sequences have no track in "
+       << "reference set " << ref;
+    throw std::runtime_error(ss.str());
+  }
+}
+
+/* Without --strict, sequences without a vector of their track are dropped
+ * and a sequence is divided by the first vector of its track only.
+ */
+void divide_by_l1(unsigned int data_set_id, unsigned int ref, bool divide_all,
+                  bool strict) {
+  pqxx::connection conn;
+  pqxx::work w(conn);
+  ts::data::FeatureVectorSet vect = ts::data::FeatureVectorSet::read(ref, w);
+  ts::data::SequenceSet seq = ts::data::SequenceSet::read(data_set_id, w);
 
-              return left.sourceDataSet() < right.sourceDataSet();
-            });
 
   unsigned int l1_index = 0;
   while (vect.frameInfo()[l1_index] != "cts_mean_lvl_1") {
@@ -76,9 +173,6 @@ void divide_by_l1(unsigned int data_set_id, unsigned int ref, bool divide_all) {
     }
   }
 
-  auto data_it = seq.begin();
-  auto ref_it = vect.begin();
-
   std::stringstream info;
   info << seq.info()
        << " Intensity divided by level 1 intensity. Extracted from data set "
@@ -88,36 +182,27 @@ void divide_by_l1(unsigned int data_set_id, unsigned int ref, bool divide_all) {
   if (seq.frameInfoSet())
     scaled.setFrameInfo(seq.frameInfo());
 
-  while(data_it != seq.end()) {
-    if (ref_it == vect.end())
-      throw std::runtime_error("Error reference set ended");
+  /* Every sequence with the vector of its track, in the order of seq */
+  auto pairs = ts::data::join(ts::data::SequenceSetView(seq),
+                              ts::data::FeatureVectorSetView(vect));
+  if (strict) check_reference(pairs, seq.size(), ref);
 
-    if ((data_it->sourceDataSet() == ref_it->sourceDataSet()) &&
-        (data_it->sourceTrackId() == ref_it->sourceTrackId())) {
-      ts::data::Sequence s(*data_it);
+  for (unsigned int i = 0; i < pairs.first.size(); i++) {
+    if (i && &pairs.first[i] == &pairs.first[i - 1]) continue;
 
-      if (divide_all)
-        for (auto& frame : s) frame /= (*ref_it)(l1_index);
-      else
-        for (auto& frame : s) {
-          frame(0) /= (*ref_it)(l1_index);
-          frame(3) /= (*ref_it)(l1_index);
-        }
+    ts::data::Sequence s(pairs.first[i]);
+    ts::real l1 = pairs.second[i](l1_index);
 
-      data_it++;
-      ref_it++;
-      scaled << s;
-    } else if (((data_it->sourceDataSet() == ref_it->sourceDataSet())
-                && (data_it->sourceTrackId() < ref_it->sourceTrackId())) ||
-               (data_it->sourceDataSet() < ref_it->sourceDataSet())) {
-      data_it++;
-    } else if (((data_it->sourceDataSet() == ref_it->sourceDataSet())
-                && (data_it->sourceTrackId() > ref_it->sourceTrackId())) ||
-               (data_it->sourceDataSet() > ref_it->sourceDataSet())) {
-      ref_it++;
-    }
+    if (divide_all)
+      for (auto& frame : s) frame /= l1;
+    else
+      for (auto& frame : s) {
+        frame(0) /= l1;
+        frame(3) /= l1;
+      }
 
-  } // endwhile
+    scaled << s;
+  }
 
   std::cout << "Storing sacled data set with id "
             << scaled.store(w) << std::endl;
@@ -125,6 +210,73 @@ void divide_by_l1(unsigned int data_set_id, unsigned int ref, bool divide_all) {
   w.commit();
 }
 
+/* divide_by_l1 reading the sequences through a cursor. The reference set,
+ * one vector per track, is kept in memory and the scaled sequences are
+ * stored a batch at a time.
+ */
+void divide_by_l1_stream(unsigned int data_set_id, unsigned int ref,
+                         bool divide_all, bool strict) {
+  pqxx::connection conn;
+  pqxx::work w(conn);
+  ts::data::FeatureVectorSet vect = ts::data::FeatureVectorSet::read(ref, w);
+
+  unsigned int l1_index = 0;
+  while (vect.frameInfo()[l1_index] != "cts_mean_lvl_1") {
+    l1_index++;
+    if (l1_index >= vect.frameInfo().size()) {
+      std::stringstream ss;
+      ss << "Error: data set with id " << ref << " does not have dimension "
+        "cts_mean_lvl_1";
+      throw std::runtime_error(ss.str());
+    }
+  }
+
+  ts::data::JoinIndex<ts::data::FeatureVector> l1(vect);
+
+  ts::data::DataSetStream<ts::data::Sequence> seq =
+    ts::data::SequenceSet::stream(data_set_id, w);
+
+  std::stringstream info;
+  info << seq.header().info()
+       << " Intensity divided by level 1 intensity. Extracted from data set "
+       << "with id " << seq.header().id();
+
+  ts::data::SequenceSet scaled(ts::funcs::splitToLines80(info.str()));
+  if (seq.header().frameInfoSet())
+    scaled.setFrameInfo(seq.header().frameInfo());
+  else
+    scaled.setDim(seq.header().dim());
+
+  ts::database_id scaled_id = scaled.storeHeader(w);
+
+  for (ts::data::SequenceSet batch; seq.next(batch); ) {
+    auto pairs = l1.join(ts::data::SequenceSetView(batch));
+    if (strict) check_reference(pairs, batch.size(), ref);
+
+    ts::data::SequenceSet scaled_batch;
+    for (unsigned int i = 0; i < pairs.first.size(); i++) {
+      if (i && &pairs.first[i] == &pairs.first[i - 1]) continue;
+
+      ts::data::Sequence t(pairs.first[i]);
+      ts::real ref = pairs.second[i](l1_index);
+
+      if (divide_all)
+        for (auto& frame : t) frame /= ref;
+      else
+        for (auto& frame : t) {
+          frame(0) /= ref;
+          frame(3) /= ref;
+        }
+      scaled_batch << t;
+    }
+    scaled_batch.storePoints(scaled_id, w);
+  }
+
+  std::cout << "Storing sacled data set with id " << scaled_id << std::endl;
+
+  w.commit();
+}
+
 
 int main(int argc, char** argv) {
 
@@ -132,7 +284,9 @@ int main(int argc, char** argv) {
   desc.add_options()
     ("help", "produce help message")
     ("data-set-id", po::value<unsigned int>(), "data set to be transformed")
-    ("type", po::value<std::string>(), "[ whiten | divide-by-l1 ]");
+    ("type", po::value<std::string>(), "[ whiten | divide-by-l1 ]")
+    ("stream", "read the data set through a cursor and store the result a "
+     "batch at a time, for data sets larger than memory");
 
   po::variables_map vm;
   po::command_line_parser parser(argc, argv);
@@ -154,18 +308,25 @@ int main(int argc, char** argv) {
   }
 
   unsigned int data_set_id = vm["data-set-id"].as<unsigned int>();
+  bool stream = vm.count("stream");
 
 
   if (vm["type"].as<std::string>() == std::string("whiten")) {
-    whiten(data_set_id);
+    if (stream)
+      whiten_stream(data_set_id);
+    else
+      whiten(data_set_id);
   } else if (vm["type"].as<std::string>() == std::string("divide-by-l1")) {
 
     po::options_description sub_desc("Divides sequence set by level 1 "
                                      "intensity");
     sub_desc.add_options()
       ("reference-set-id", po::value<unsigned int>(),
-       "data set used to extract the level 1 intensity")
-      ("divide-all", "whether to divide all dimensions or just Intensity");
+       "data set used to extract the level 1 intensity. Sequences without a "
+       "vector of their track are dropped")
+      ("divide-all", "whether to divide all dimensions or just Intensity")
+      ("strict", "fail unless the reference set holds exactly one vector for "
+       "the track of every sequence");
 
     po::variables_map sub_vm;
     po::command_line_parser sub_parser(argc, argv);
@@ -183,7 +344,13 @@ int main(int argc, char** argv) {
     unsigned int reference_set_id =
       sub_vm["reference-set-id"].as<unsigned int>();
 
-    divide_by_l1(data_set_id, reference_set_id, !!sub_vm.count("divide-all"));
+    if (stream)
+      divide_by_l1_stream(data_set_id, reference_set_id,
+                          !!sub_vm.count("divide-all"),
+                          !!sub_vm.count("strict"));
+    else
+      divide_by_l1(data_set_id, reference_set_id, !!sub_vm.count("divide-all"),
+                   !!sub_vm.count("strict"));
 
   } else {
     std::cerr << "Error unrecognised data set type "